@@ -0,0 +1,484 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <chrono>
+
+#include "flowgraph.h"
+#include "flowresult.h"
+#include "flowstats.h"
+#include "workerpool.h"
+
+using namespace std;
+
+#define NUM_THREADS static_cast<int>(thread::hardware_concurrency())
+
+namespace paper {
+
+// Capacity type Cap and arc index type Index as in BasicFlowGraph.
+template <class Cap = int, class Index = uint32_t>
+class BasicDinic {
+    typedef BasicFlowGraph<Cap, Index> Graph;
+    typedef typename Graph::Edge Edge;
+    typedef typename Graph::Flow Flow;
+    int V;
+    Graph g;
+    WorkerPool pool;  // Persistent BFS workers, reused across levels and phases
+    vector<int> level;
+    vector<Index> ptr;
+    vector<Index> path;  // Arc stack of blockingFlow
+    long long paths_found = 0;  // Augmenting paths of the current phase, for stats
+    mutex level_mutex;  // Used to protect level updates in BFS
+    // Scratch of the parallel BFS modes, sized on first use: the current and next frontier, each
+    // worker's share of the next one, and the bottom-up membership marks (all 0 between levels).
+    vector<int> frontier, next_frontier;
+    vector<WorkerBuffer> local_frontiers;
+    vector<char> in_frontier;
+
+public:
+    enum BFSMode { SEQUENTIAL_BFS, PARALLEL_BFS, LOCK_FREE_BFS, DIRECTION_OPTIMIZING_BFS };
+
+    // Direction-optimizing switch thresholds (Beamer et al. use 14 and 24).
+    static const int DO_ALPHA = 14;
+    static const int DO_BETA = 24;
+
+    BFSMode bfs_mode = PARALLEL_BFS;
+    // Arcs inspected by level graph construction over all phases, plus one per vertex a
+    // bottom-up level sweeps.
+    atomic<long long> arcs_scanned{0};
+
+    // Phases and time spent building level graphs and pushing blocking flows in the last maxFlow.
+    int phases = 0;
+    double bfs_ms = 0, dfs_ms = 0;
+    // Per-phase counters and timings of the last maxFlow; filled in only when built with
+    // FLOW_STATS (see flowstats.h).
+    FlowStats stats;
+
+    BasicDinic(int V, int num_threads = NUM_THREADS) : V(V), g(V), pool(num_threads), level(V, -1), ptr(V, 0) {}
+
+    // Add an edge from u to v with given capacity, and the reverse edge with 0 capacity.
+    // Returns the edge's id for setCapacity and removeEdge.
+    size_t addEdge(int u, int v, Cap cap) {
+        return g.addEdge(u, v, cap);
+    }
+
+    // Bulk form of addEdge for loaders; takes over the list.
+    void addEdges(vector<typename Graph::InputEdge> &&edges) {
+        g.addEdges(move(edges));
+    }
+
+    // Freeze the added edges into the CSR arc array, on the solver's pool when there are many.
+    // maxFlow calls it if the caller didn't.
+    void finalize() {
+        g.finalize(&pool);
+    }
+
+    // Save the finalized graph as a binary snapshot, or open one instead of adding edges
+    // (see FlowGraph). The snapshot must have this solver's vertex count.
+    void saveSnapshot(const string &path) {
+        finalize();
+        g.saveSnapshot(path);
+    }
+
+    void openSnapshot(const string &path) {
+        g.openSnapshot(path);
+    }
+
+    // ---------------- Incremental Updates ----------------
+    // maxFlow keeps its flow in the graph and the next call with the same s and t continues
+    // from it, so edges can be changed between calls without starting over. Edges added after
+    // a solve are merged in by the next one; a lowered or removed edge has its flow repaired
+    // locally first (see FlowGraph).
+    void setCapacity(size_t edge, Cap cap) {
+        g.setCapacity(edge, cap);
+    }
+
+    void removeEdge(size_t edge) {
+        g.removeEdge(edge);
+    }
+
+    Flow edgeFlow(size_t edge) const {
+        return g.edgeFlow(edge);
+    }
+
+    // Drop the kept flow so the next maxFlow starts from zero.
+    void resetFlow() {
+        g.resetFlow();
+    }
+
+    // ---------------- Sequential BFS ----------------
+    // Plain queue-based level graph construction, kept as the baseline for the parallel modes.
+    bool bfs(int s, int t) {
+        fill(level.begin(), level.end(), -1);
+        queue<int> q;
+        q.push(s);
+        level[s] = 0;
+        long long scanned = 0;
+        while (!q.empty()) {
+            int u = q.front(); q.pop();
+            scanned += g.off[u + 1] - g.off[u];
+            for (Index j = g.off[u]; j < g.off[u + 1]; j++) {
+                Edge &e = g.arcs[j];
+                if (level[e.v] == -1 && e.res > 0) {
+                    level[e.v] = level[u] + 1;
+                    q.push(e.v);
+                }
+            }
+        }
+        arcs_scanned += scanned;
+        return level[t] != -1;
+    }
+
+    // ---------------- Parallel BFS Worker (as described in the paper) ----------------
+    // This worker processes a chunk of the frontier and writes discovered nodes into its local buffer.
+    void bfs_worker(const vector<int>& frontier, int start, int end,
+                    vector<WorkerBuffer>& local_frontiers, int thread_id) {
+        long long scanned = 0;
+        for (int i = start; i < end; i++) {
+            int u = frontier[i];
+            scanned += g.off[u + 1] - g.off[u];
+            for (Index j = g.off[u]; j < g.off[u + 1]; j++) {
+                Edge &e = g.arcs[j];
+                // Use lock_guard to update shared 'level'
+                lock_guard<mutex> lock(level_mutex);
+                if (level[e.v] == -1 && e.res > 0) {
+                    level[e.v] = level[u] + 1;
+                    local_frontiers[thread_id].items.push_back(e.v);
+                }
+            }
+        }
+        arcs_scanned += scanned;
+    }
+
+    // ---------------- Lock-Free BFS Worker ----------------
+    // Same contract as bfs_worker without the mutex: a node is claimed by a compare-and-swap of
+    // its level from -1, so exactly one thread labels it and adds it to its padded local buffer.
+    // The pool barrier between levels publishes the claims; no other per-edge synchronization.
+    void lock_free_bfs_worker(const vector<int>& frontier, int start, int end,
+                              vector<WorkerBuffer>& local_frontiers, int thread_id) {
+        vector<int> &out = local_frontiers[thread_id].items;
+        long long scanned = 0;
+        for (int i = start; i < end; i++) {
+            int u = frontier[i];
+            int next_level = level[u] + 1;
+            scanned += g.off[u + 1] - g.off[u];
+            for (Index j = g.off[u]; j < g.off[u + 1]; j++) {
+                Edge &e = g.arcs[j];
+                if (e.res > 0 && __atomic_load_n(&level[e.v], __ATOMIC_RELAXED) == -1) {
+                    int expected = -1;
+                    if (__atomic_compare_exchange_n(&level[e.v], &expected, next_level, false,
+                                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                        out.push_back(e.v);
+                }
+            }
+        }
+        arcs_scanned += scanned;
+    }
+
+    // ---------------- Bottom-Up BFS Worker ----------------
+    // Each unvisited vertex v in [start, end) looks through its own arcs v -> u for a parent u
+    // on the frontier whose arc u -> v (the reverse arc) still has residual capacity, and stops
+    // at the first one. Only v's own level entry is written, so no locking is needed. The sweep
+    // visits every vertex of the range, so each counts as one scan on top of the arcs.
+    void bottom_up_worker(int start, int end, int cur_level, const vector<char>& in_frontier,
+                          vector<WorkerBuffer>& local_frontiers, int thread_id) {
+        long long scanned = end - start;
+        for (int v = start; v < end; v++) {
+            if (level[v] != -1)
+                continue;
+            for (Index j = g.off[v]; j < g.off[v + 1]; j++) {
+                scanned++;
+                Edge &e = g.arcs[j];
+                Edge &in = g.arcs[e.rev];
+                if (in_frontier[e.v] && in.res > 0) {
+                    level[v] = cur_level + 1;
+                    local_frontiers[thread_id].items.push_back(v);
+                    break;
+                }
+            }
+        }
+        arcs_scanned += scanned;
+    }
+
+    // Expand one level top-down: hand the frontier to the pool in chunks; use fewer chunks if the
+    // frontier is small, in which case the calling thread expands it alone without waking the workers.
+    // lock_free selects lock_free_bfs_worker instead of the paper's mutex-based bfs_worker.
+    void expandTopDown(const vector<int>& frontier, vector<WorkerBuffer>& local_frontiers,
+                       bool lock_free) {
+        int f_size = frontier.size();
+        int num_chunks = min(pool.size(), max(1, f_size / 500));
+        int chunk_size = (f_size + num_chunks - 1) / num_chunks;
+        pool.run(num_chunks, [&](int i, int worker_id) {
+            int start = i * chunk_size;
+            int end = min((i + 1) * chunk_size, f_size);
+            if (start >= end)
+                return;
+            if (lock_free)
+                lock_free_bfs_worker(frontier, start, end, local_frontiers, worker_id);
+            else
+                bfs_worker(frontier, start, end, local_frontiers, worker_id);
+        });
+    }
+
+    // Expand one level bottom-up over all vertices, split into ranges for the pool.
+    void expandBottomUp(int cur_level, const vector<char>& in_frontier,
+                        vector<WorkerBuffer>& local_frontiers) {
+        int num_chunks = min(pool.size() * 4, max(1, V / 2048));
+        int chunk_size = (V + num_chunks - 1) / num_chunks;
+        pool.run(num_chunks, [&](int i, int worker_id) {
+            int start = i * chunk_size;
+            int end = min((i + 1) * chunk_size, V);
+            if (start < end)
+                bottom_up_worker(start, end, cur_level, in_frontier, local_frontiers, worker_id);
+        });
+    }
+
+    // Size the parallel BFS scratch the first time one runs.
+    void prepareFrontiers() {
+        if (!local_frontiers.empty())
+            return;
+        local_frontiers.resize(pool.size());
+        for (auto &lf : local_frontiers)
+            lf.items.reserve(V / pool.size() + 10);
+        in_frontier.assign(V, 0);
+    }
+
+    // ---------------- Parallel BFS ----------------
+    // This function partitions the current frontier among threads, each writes into its local buffer.
+    // With lock_free the workers claim nodes by CAS instead of taking level_mutex per edge.
+    bool parallelBFS(int s, int t, bool lock_free = false) {
+        fill(level.begin(), level.end(), -1);
+        prepareFrontiers();
+        frontier.assign(1, s);
+        level[s] = 0;
+
+        while (!frontier.empty()) {
+            for (auto &lf : local_frontiers)
+                lf.items.clear();
+
+            expandTopDown(frontier, local_frontiers, lock_free);
+
+            next_frontier.clear();
+            for (auto &lf : local_frontiers)
+                next_frontier.insert(next_frontier.end(), lf.items.begin(), lf.items.end());
+            
+            frontier.swap(next_frontier);
+        }
+        return level[t] != -1;
+    }
+
+    // ---------------- Direction-Optimizing BFS ----------------
+    // Same level array as bfs/parallelBFS, but once a growing frontier's arcs outnumber the arcs
+    // of still-unvisited vertices by DO_ALPHA, levels are expanded bottom-up so that each
+    // unvisited vertex stops scanning at its first parent. It goes back to top-down once the
+    // frontier is shrinking and holds fewer than V / DO_BETA vertices (Beamer et al.). Requiring
+    // growth to switch and shrinkage to switch back keeps the direction from flipping between
+    // levels, and keeps a frontier of constant width, as on a long chain, top-down. Top-down
+    // levels use the lock-free worker.
+    bool directionOptimizingBFS(int s, int t) {
+        fill(level.begin(), level.end(), -1);
+        prepareFrontiers();
+        frontier.assign(1, s);
+        level[s] = 0;
+
+        long long unexplored_arcs = g.off[V] - (g.off[s + 1] - g.off[s]);
+        bool bottom_up = false;
+        int prev_size = 0;
+
+        for (int cur_level = 0; !frontier.empty(); cur_level++) {
+            int f_size = frontier.size();
+            long long frontier_arcs = 0;
+            for (int u : frontier)
+                frontier_arcs += g.off[u + 1] - g.off[u];
+
+            if (!bottom_up && f_size > prev_size && frontier_arcs > unexplored_arcs / DO_ALPHA)
+                bottom_up = true;
+            else if (bottom_up && f_size < prev_size && f_size < V / DO_BETA)
+                bottom_up = false;
+
+            for (auto &lf : local_frontiers)
+                lf.items.clear();
+
+            if (bottom_up) {
+                for (int u : frontier)
+                    in_frontier[u] = 1;
+                expandBottomUp(cur_level, in_frontier, local_frontiers);
+                for (int u : frontier)
+                    in_frontier[u] = 0;
+            } else {
+                expandTopDown(frontier, local_frontiers, true);
+            }
+
+            next_frontier.clear();
+            for (auto &lf : local_frontiers)
+                next_frontier.insert(next_frontier.end(), lf.items.begin(), lf.items.end());
+            for (int v : next_frontier)
+                unexplored_arcs -= g.off[v + 1] - g.off[v];
+
+            prev_size = f_size;
+            frontier.swap(next_frontier);
+        }
+        return level[t] != -1;
+    }
+
+    // Build the level graph with the selected BFS mode.
+    bool buildLevelGraph(int s, int t) {
+        switch (bfs_mode) {
+        case SEQUENTIAL_BFS:
+            return bfs(s, t);
+        case LOCK_FREE_BFS:
+            return parallelBFS(s, t, true);
+        case DIRECTION_OPTIMIZING_BFS:
+            return directionOptimizingBFS(s, t);
+        default:
+            return parallelBFS(s, t);
+        }
+    }
+
+    // ---------------- Sequential DFS (unchanged) ----------------
+    // Single-path recursive DFS, kept for comparison; maxFlow uses blockingFlow.
+    Cap dfs(int u, int t, Cap flow) {
+        if (u == t)
+            return flow;
+        for (Index &i = ptr[u]; i < g.off[u + 1]; i++) {
+            Edge &e = g.arcs[i];
+            if (level[e.v] == level[u] + 1 && e.res > 0) {
+                Cap pushed = dfs(e.v, t, min(flow, e.res));
+                if (pushed > 0) {
+                    e.res -= pushed;
+                    g.arcs[e.rev].res += pushed;
+                    return pushed;
+                }
+            }
+        }
+        return 0;
+    }
+
+    // ---------------- Blocking Flow (Iterative) ----------------
+    // Finds a blocking flow in the level graph without recursion. 'path' holds the arcs from s to
+    // the current vertex and ptr[] the current arc of every vertex. On reaching t the path is
+    // augmented by its bottleneck and the search retreats only to the tail of the first arc it
+    // saturated, so the flow still available on the rest of the path goes down the next branch
+    // instead of re-walking from s. A vertex whose arcs are exhausted is a dead end: the search
+    // retreats and its parent skips the arc leading to it for the rest of the phase.
+    Flow blockingFlow(int s, int t) {
+        Flow total = 0;
+        path.clear();
+        int u = s;
+        while (true) {
+            if (u == t) {
+                Cap pushed = numeric_limits<Cap>::max();
+                for (Index a : path)
+                    pushed = min(pushed, g.arcs[a].res);
+                int saturated = -1;
+                for (int i = 0; i < (int)path.size(); i++) {
+                    Edge &e = g.arcs[path[i]];
+                    e.res -= pushed;
+                    g.arcs[e.rev].res += pushed;
+                    if (saturated == -1 && e.res == 0)
+                        saturated = i;
+                }
+                total += pushed;
+                if constexpr (FlowStats::ENABLED)
+                    paths_found++;
+                u = g.arcs[g.arcs[path[saturated]].rev].v;
+                path.resize(saturated);
+                continue;
+            }
+
+            Index &i = ptr[u];
+            while (i < g.off[u + 1] &&
+                   !(level[g.arcs[i].v] == level[u] + 1 && g.arcs[i].res > 0))
+                i++;
+
+            if (i < g.off[u + 1]) {
+                path.push_back(i);
+                u = g.arcs[i].v;
+            } else {
+                if (u == s)
+                    break;
+                Index a = path.back();
+                path.pop_back();
+                u = g.arcs[g.arcs[a].rev].v;
+                ptr[u]++;
+            }
+        }
+        return total;
+    }
+
+    // ---------------- Max Flow Computation ----------------
+    Flow maxFlow(int s, int t) {
+        finalize();
+        g.repairFlow(s, t);
+        phases = 0;
+        bfs_ms = dfs_ms = 0;
+        if constexpr (FlowStats::ENABLED)
+            stats.clear();
+        long long scanned = arcs_scanned;
+        Flow flow = g.outflow(s);
+        auto start = chrono::steady_clock::now(), t0 = start;
+        while (buildLevelGraph(s, t)) {
+            auto t1 = chrono::steady_clock::now();
+            copy(g.off.begin(), g.off.end() - 1, ptr.begin());
+            Flow pushed = blockingFlow(s, t);
+            flow += pushed;
+            auto t2 = chrono::steady_clock::now();
+            double phase_bfs = chrono::duration<double, milli>(t1 - t0).count();
+            double phase_dfs = chrono::duration<double, milli>(t2 - t1).count();
+            bfs_ms += phase_bfs;
+            dfs_ms += phase_dfs;
+            phases++;
+            t0 = t2;
+            if constexpr (FlowStats::ENABLED) {
+                recordPhase(t, phase_bfs, phase_dfs, arcs_scanned - scanned, pushed);
+                scanned = arcs_scanned;
+                t0 = chrono::steady_clock::now();  // keep the bookkeeping out of the next BFS
+            }
+        }
+        double last_bfs = msSince(t0);
+        bfs_ms += last_bfs;
+        if constexpr (FlowStats::ENABLED) {
+            stats.final_bfs_ms = last_bfs;
+            stats.final_bfs_arcs = arcs_scanned - scanned;
+            stats.total_ms = msSince(start);
+        }
+        return flow;
+    }
+
+    void recordPhase(int t, double bfs, double dfs, long long bfs_arcs, Flow pushed) {
+        PhaseStats p;
+        p.bfs_ms = bfs;
+        p.dfs_ms = dfs;
+        p.bfs_arcs = bfs_arcs;
+        p.dfs_arcs = retiredArcs(g, ptr);
+        p.paths = paths_found;
+        p.flow = (double)pushed;
+        p.sink_level = level[t];
+        stats.phases.push_back(p);
+        paths_found = 0;
+    }
+
+    // ---------------- Results ----------------
+    typedef BasicFlowResult<Cap, Index> Result;
+
+    // maxFlow plus the minimum cut and a view of the arc flows (see flowresult.h). The last BFS
+    // of maxFlow failed to reach t, so its levels already mark the source side.
+    Result solve(int s, int t) {
+        Flow flow = maxFlow(s, t);
+        return makeFlowResult(g, flow, [&](int v) { return level[v] != -1; }, &pool);
+    }
+};
+
+typedef BasicDinic<> Dinic;
+
+} // namespace paper
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <numeric>
+#include <algorithm>
+
+#include "flowgraph.h"
+#include "origdinicalgo.h"
+#include "workerpool.h"
+
+using namespace std;
+
+#define NUM_THREADS static_cast<int>(thread::hardware_concurrency())
+
+// ---------------- Batch Solver ----------------
+// Max flows of many independent instances. Each pool worker solves whole instances with its own
+// sequential orig::Dinic, so nothing is shared between solves and small instances pay no
+// per-level threading cost. A worker's Dinic is its arena: assign() rebuilds the graph inside
+// the arrays left by the previous instance, so after the largest instance has been seen a
+// worker stops allocating. Instances are handed out largest first, which keeps one big
+// straggler from running alone at the end, and results come back in input order.
+//
+//   BatchSolver batch;
+//   vector<long long> flows = batch.solve(instances);
+//
+// The generator form pulls instances through next(FlowInstance &), which fills one and returns
+// false at the end. They are read and solved a block at a time, so the whole stream never has
+// to be in memory.
+template <class Cap = int, class Index = uint32_t>
+class BasicBatchSolver {
+    typedef orig::BasicDinic<Cap, Index> Engine;
+
+public:
+    typedef FlowSum<Cap> Flow;
+    typedef FlowInstance<Cap> Instance;
+
+    BasicBatchSolver(int num_threads = NUM_THREADS)
+        : pool(num_threads), engines(pool.size(), Engine(0)) {}
+
+    vector<Flow> solve(const vector<Instance> &instances) {
+        vector<Flow> flows(instances.size());
+        solveRange(instances, instances.size(), flows.data());
+        return flows;
+    }
+
+    template <class Next>
+    vector<Flow> solve(Next next) {
+        vector<Flow> flows;
+        vector<Instance> block(pool.size() * BLOCK_PER_WORKER);
+        while (true) {
+            size_t n = 0;
+            while (n < block.size() && next(block[n]))
+                n++;
+            if (n == 0)
+                break;
+            flows.resize(flows.size() + n);
+            solveRange(block, n, flows.data() + flows.size() - n);
+        }
+        return flows;
+    }
+
+private:
+    static const int BLOCK_PER_WORKER = 16;  // generator instances in flight per worker
+
+    WorkerPool pool;
+    vector<Engine> engines;  // one per worker, reused across instances
+    vector<int> order;
+
+    // Solve instances[0 .. n) into out[0 .. n), largest edge list first.
+    void solveRange(const vector<Instance> &instances, size_t n, Flow *out) {
+        order.resize(n);
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return instances[a].edges.size() > instances[b].edges.size();
+        });
+        pool.run((int)n, [&](int k, int worker_id) {
+            const Instance &in = instances[order[k]];
+            Engine &e = engines[worker_id];
+            e.assign(in.V, in.edges);
+            out[order[k]] = e.maxFlow(in.s, in.t);
+        });
+    }
+};
+
+typedef BasicBatchSolver<> BatchSolver;
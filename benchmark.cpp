@@ -0,0 +1,506 @@
+#include <bits/stdc++.h>
+
+#include "origdinicalgo.h"
+#include "algofrompapernotimproved.h"
+#include "improvingalgo.h"
+#include "pushrelabel.h"
+#include "parallelpushrelabel.h"
+#include "boykovkolmogorov.h"
+#include "pseudoflow.h"
+#include "reorder.h"
+#include "batchsolver.h"
+#include "graphgen.h"
+#include "dimacs.h"
+
+using namespace std;
+
+// Benchmark driver: runs every registered max-flow solver on the same graphs, checks that the
+// flow values agree and writes one row per timed run.
+//
+//   benchmark [--runs N] [--threads N] [--solvers a,b,...] [--csv FILE] [--json FILE]
+//             [--dimacs FILE]... [--batch N] [--incremental N]
+//
+// Every --dimacs file is added to the built-in graph set. --batch N also measures throughput on
+// N small independent instances (see runBatch). --incremental N edits a few graphs N times and
+// checks the solvers' incremental updates against solving from scratch (see runIncremental).
+// Built with -DFLOW_STATS, each JSON row also carries the solver's per-phase statistics (see
+// flowstats.h).
+
+// ---------------- Instances ----------------
+struct Instance {
+    string name;
+    int V, s, t;
+    vector<FlowGraph::InputEdge> edges;
+};
+
+// Materialise a generator once, so every solver and run replays identical arcs and the
+// generation cost stays out of build_ms.
+template <class Gen>
+Instance instance(const Gen &gen) {
+    Instance in{gen.name(), gen.vertices(), gen.source(), gen.sink(), {}};
+    gen.generate([&](int u, int v, int cap) { in.edges.push_back({u, v, cap}); });
+    return in;
+}
+
+// ---------------- Solvers ----------------
+struct RunResult {
+    long long flow = 0;
+    double build_ms = 0, solve_ms = 0, bfs_ms = 0, dfs_ms = 0;
+    int phases = 0;
+    string stats;  // FlowStats JSON of the solve, in FLOW_STATS builds
+};
+
+struct SolverEntry {
+    string name;
+    bool parallel;
+    function<RunResult(const Instance&, int)> run;  // (instance, threads)
+};
+
+// Solvers that keep a FlowStats of their last solve (see flowstats.h).
+template <class Solver, class = void>
+struct HasFlowStats : false_type {};
+
+template <class Solver>
+struct HasFlowStats<Solver, void_t<decltype(declval<Solver &>().stats.json())>> : true_type {};
+
+// Time edge ingestion plus finalize, then solve(solver), by default maxFlow.
+template <class Solver, class Solve>
+RunResult runSolver(Solver &solver, const Instance &in, Solve solve) {
+    RunResult r;
+    auto start = chrono::steady_clock::now();
+    vector<FlowGraph::InputEdge> edges = in.edges;
+    solver.addEdges(move(edges));
+    solver.finalize();
+    r.build_ms = msSince(start);
+
+    start = chrono::steady_clock::now();
+    r.flow = solve(solver);
+    r.solve_ms = msSince(start);
+    if constexpr (FlowStats::ENABLED && HasFlowStats<Solver>::value)
+        r.stats = solver.stats.json();
+    return r;
+}
+
+template <class Solver>
+RunResult runSolver(Solver &solver, const Instance &in) {
+    return runSolver(solver, in, [&](Solver &x) { return x.maxFlow(in.s, in.t); });
+}
+
+// Dinic variants also report their phase count and the BFS/DFS time split.
+template <class Solver>
+RunResult runDinic(Solver &solver, const Instance &in) {
+    RunResult r = runSolver(solver, in);
+    r.phases = solver.phases;
+    r.bfs_ms = solver.bfs_ms;
+    r.dfs_ms = solver.dfs_ms;
+    return r;
+}
+
+// orig::Dinic on renumbered vertices (see reorder.h). build_ms includes computing the order,
+// except BFS_ORDER's, which waits for s and so lands in solve_ms.
+RunResult runReordered(VertexOrder order, const Instance &in) {
+    Reordered<orig::Dinic> r(in.V, order);
+    RunResult res = runSolver(r, in);
+    orig::Dinic &d = r.solver();
+    res.phases = d.phases;
+    res.bfs_ms = d.bfs_ms;
+    res.dfs_ms = d.dfs_ms;
+    if constexpr (FlowStats::ENABLED)
+        res.stats = d.stats.json();
+    return res;
+}
+
+vector<SolverEntry> registeredSolvers() {
+    return {
+        {"orig-dinic", false, [](const Instance &in, int) {
+            orig::Dinic d(in.V);
+            return runDinic(d, in);
+        }},
+        {"orig-dinic-scaling", false, [](const Instance &in, int) {
+            orig::Dinic d(in.V);
+            d.scaling = true;
+            return runDinic(d, in);
+        }},
+        {"orig-dinic-sink-bfs", false, [](const Instance &in, int) {
+            orig::Dinic d(in.V);
+            d.sink_bfs = true;
+            return runDinic(d, in);
+        }},
+        {"orig-dinic-bfs-order", false, [](const Instance &in, int) {
+            return runReordered(BFS_ORDER, in);
+        }},
+        {"orig-dinic-rcm", false, [](const Instance &in, int) {
+            return runReordered(RCM_ORDER, in);
+        }},
+        {"orig-dinic-degree", false, [](const Instance &in, int) {
+            return runReordered(DEGREE_ORDER, in);
+        }},
+        {"boykov-kolmogorov", false, [](const Instance &in, int) {
+            BoykovKolmogorov bk(in.V);
+            return runSolver(bk, in);
+        }},
+        {"paper-dinic-seq", false, [](const Instance &in, int threads) {
+            paper::Dinic d(in.V, threads);
+            d.bfs_mode = paper::Dinic::SEQUENTIAL_BFS;
+            return runDinic(d, in);
+        }},
+        {"paper-dinic-parallel", true, [](const Instance &in, int threads) {
+            paper::Dinic d(in.V, threads);
+            d.bfs_mode = paper::Dinic::PARALLEL_BFS;
+            return runDinic(d, in);
+        }},
+        {"paper-dinic-lockfree", true, [](const Instance &in, int threads) {
+            paper::Dinic d(in.V, threads);
+            d.bfs_mode = paper::Dinic::LOCK_FREE_BFS;
+            return runDinic(d, in);
+        }},
+        {"paper-dinic-diropt", true, [](const Instance &in, int threads) {
+            paper::Dinic d(in.V, threads);
+            d.bfs_mode = paper::Dinic::DIRECTION_OPTIMIZING_BFS;
+            return runDinic(d, in);
+        }},
+        {"improving-dinic-blocking", true, [](const Instance &in, int threads) {
+            improving::Dinic d(in.V, threads);
+            d.dfs_mode = improving::Dinic::BLOCKING_FLOW;
+            return runDinic(d, in);
+        }},
+        {"improving-dinic-paralleldfs", true, [](const Instance &in, int threads) {
+            improving::Dinic d(in.V, threads);
+            d.dfs_mode = improving::Dinic::PARALLEL_DFS;
+            return runDinic(d, in);
+        }},
+        {"improving-dinic-numa", true, [](const Instance &in, int threads) {
+            improving::Dinic d(in.V, threads, &NumaTopology::machine());
+            d.dfs_mode = improving::Dinic::BLOCKING_FLOW;
+            return runDinic(d, in);
+        }},
+        {"push-relabel", false, [](const Instance &in, int) {
+            PushRelabel pr(in.V);
+            return runSolver(pr, in);
+        }},
+        {"parallel-push-relabel", true, [](const Instance &in, int threads) {
+            ParallelPushRelabel pr(in.V, threads);
+            return runSolver(pr, in);
+        }},
+        {"pseudoflow", false, [](const Instance &in, int) {
+            Pseudoflow pf(in.V);
+            return runSolver(pf, in);
+        }},
+        {"pseudoflow-phase1", false, [](const Instance &in, int) {
+            Pseudoflow pf(in.V);
+            return runSolver(pf, in, [&](Pseudoflow &x) { return x.minCut(in.s, in.t); });
+        }},
+    };
+}
+
+// ---------------- Batch Throughput ----------------
+// N seeded instances of 1k-50k vertices (random, grid and layered), solved one at a time by
+// orig::Dinic and by improving::Dinic on all threads, then by BatchSolver on 1, 2, 4, ... up to
+// 'threads' workers. Prints instances per second; false if any flow differs from orig::Dinic's.
+bool runBatch(int count, int threads) {
+    vector<FlowInstance<>> batch(count);
+    GenRng rng(12);
+    for (auto &in : batch) {
+        auto take = [&](const auto &gen) {
+            in.V = gen.vertices();
+            in.s = gen.source();
+            in.t = gen.sink();
+            gen.generate([&](int u, int v, int cap) { in.edges.push_back({u, v, cap}); });
+        };
+        switch (rng.range(0, 2)) {
+        case 0: {
+            int n = rng.range(1000, 50000);
+            take(RandomGraph{n, 3LL * n, 100, rng.next()});
+            break;
+        }
+        case 1: take(GridGraph{20, rng.range(50, 500), 1, 100, rng.next()}); break;
+        default: take(LayeredGraph{8, rng.range(125, 1250), 3, 100, rng.next()}); break;
+        }
+    }
+
+    cout << "\nBatch of " << count << " instances" << endl;
+    auto report = [&](const string &name, double ms) {
+        cout << "  " << left << setw(30) << name << right << fixed << setprecision(1)
+             << setw(10) << count / (ms / 1000) << " instances/s" << defaultfloat << endl;
+    };
+
+    vector<long long> expected(count);
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        orig::Dinic d(batch[i].V);
+        d.addEdges(vector<FlowGraph::InputEdge>(batch[i].edges));
+        expected[i] = d.maxFlow(batch[i].s, batch[i].t);
+    }
+    report("orig-dinic one at a time", msSince(start));
+
+    bool agree = true;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        improving::Dinic d(batch[i].V, threads);
+        d.addEdges(vector<FlowGraph::InputEdge>(batch[i].edges));
+        agree = agree && d.maxFlow(batch[i].s, batch[i].t) == expected[i];
+    }
+    report("improving-dinic one at a time", msSince(start));
+
+    for (int workers = 1;; workers = min(workers * 2, threads)) {
+        BatchSolver solver(workers);
+        start = chrono::steady_clock::now();
+        agree = agree && solver.solve(batch) == expected;
+        report("batch, " + to_string(workers) + " workers", msSince(start));
+        if (workers == threads)
+            break;
+    }
+    if (!agree)
+        cout << "  MISMATCH" << endl;
+    return agree;
+}
+
+// ---------------- Incremental Updates ----------------
+// 'rounds' rounds of edits on a few seeded graphs. Each round changes the capacity of 1% of the
+// live edges (up or down, a tenth of them to removal) and adds as many new edges. orig::Dinic and
+// improving::Dinic then continue from their kept flow (setCapacity, removeEdge, addEdge and
+// maxFlow), while a fresh orig::Dinic solves the edited edge list from scratch. The kept flow is
+// also checked edge by edge: within capacity and conserved at every vertex but s and t. Prints
+// the time per round of each; false if any flow differs or is invalid.
+template <class Solver>
+bool validEdgeFlows(const Solver &d, const Instance &in, const vector<char> &removed, long long flow) {
+    vector<long long> net(in.V, 0);
+    for (size_t i = 0; i < in.edges.size(); i++) {
+        long long f = removed[i] ? 0 : (long long)d.edgeFlow(i);
+        if ((removed[i] && d.edgeFlow(i) != 0) || f < 0 || f > in.edges[i].cap)
+            return false;
+        net[in.edges[i].u] += f;
+        net[in.edges[i].v] -= f;
+    }
+    for (int v = 0; v < in.V; v++)
+        if (net[v] != (v == in.s ? flow : v == in.t ? -flow : 0))
+            return false;
+    return true;
+}
+
+bool runIncremental(int rounds, int threads) {
+    vector<Instance> graphs = {instance(RandomGraph{20000, 100000, 100, 21}),
+                               instance(GridGraph{100, 100, 1, 100, 22}),
+                               instance(LayeredGraph{50, 200, 3, 100, 23})};
+    bool agree = true;
+    for (auto &in : graphs) {
+        GenRng rng(24);
+        vector<char> removed(in.edges.size(), 0);
+        orig::Dinic inc(in.V);
+        improving::Dinic par(in.V, threads);
+        inc.addEdges(vector<FlowGraph::InputEdge>(in.edges));
+        par.addEdges(vector<FlowGraph::InputEdge>(in.edges));
+        inc.maxFlow(in.s, in.t);
+        par.maxFlow(in.s, in.t);
+        double inc_ms = 0, par_ms = 0, fresh_ms = 0;
+        for (int round = 0; round < rounds; round++) {
+            int changes = max<int>(1, (int)in.edges.size() / 100);
+            for (int k = 0; k < changes; k++) {
+                size_t e = rng.next() % in.edges.size();
+                if (removed[e])
+                    continue;
+                if (rng.range(0, 9) == 0) {
+                    removed[e] = 1;
+                    in.edges[e].cap = 0;
+                    inc.removeEdge(e);
+                    par.removeEdge(e);
+                } else {
+                    in.edges[e].cap = rng.range(0, 200);
+                    inc.setCapacity(e, in.edges[e].cap);
+                    par.setCapacity(e, in.edges[e].cap);
+                }
+            }
+            for (int k = 0; k < changes; k++) {
+                FlowGraph::InputEdge e{rng.range(0, in.V - 1), rng.range(0, in.V - 1), rng.range(1, 100)};
+                in.edges.push_back(e);
+                removed.push_back(0);
+                inc.addEdge(e.u, e.v, e.cap);
+                par.addEdge(e.u, e.v, e.cap);
+            }
+
+            auto start = chrono::steady_clock::now();
+            long long inc_flow = inc.maxFlow(in.s, in.t);
+            inc_ms += msSince(start);
+            start = chrono::steady_clock::now();
+            long long par_flow = par.maxFlow(in.s, in.t);
+            par_ms += msSince(start);
+            start = chrono::steady_clock::now();
+            orig::Dinic fresh(in.V);
+            fresh.addEdges(vector<FlowGraph::InputEdge>(in.edges));
+            long long expected = fresh.maxFlow(in.s, in.t);
+            fresh_ms += msSince(start);
+
+            agree = agree && inc_flow == expected && par_flow == expected &&
+                    validEdgeFlows(inc, in, removed, inc_flow) &&
+                    validEdgeFlows(par, in, removed, par_flow);
+        }
+        cout << "\nIncremental " << in.name << ", " << rounds << " rounds" << endl;
+        for (auto row : {make_pair("orig-dinic incremental", inc_ms),
+                         make_pair("improving-dinic incremental", par_ms),
+                         make_pair("orig-dinic rebuilt", fresh_ms)})
+            cout << "  " << left << setw(30) << row.first << right << fixed << setprecision(2)
+                 << setw(10) << row.second / max(1, rounds) << " ms/round" << defaultfloat << endl;
+    }
+    if (!agree)
+        cout << "  MISMATCH" << endl;
+    return agree;
+}
+
+// ---------------- Output ----------------
+struct Row {
+    string graph, solver;
+    int V;
+    size_t E;
+    int threads, run;
+    RunResult r;
+    bool agree;
+};
+
+void writeCSV(const string &path, const vector<Row> &rows) {
+    ofstream out(path);
+    out << "graph,V,E,solver,threads,run,flow,build_ms,solve_ms,bfs_ms,dfs_ms,phases,"
+           "bfs_ms_per_phase,dfs_ms_per_phase,agree\n";
+    for (auto &row : rows) {
+        int p = max(1, row.r.phases);
+        out << row.graph << ',' << row.V << ',' << row.E << ',' << row.solver << ','
+            << row.threads << ',' << row.run << ',' << row.r.flow << ','
+            << row.r.build_ms << ',' << row.r.solve_ms << ',' << row.r.bfs_ms << ','
+            << row.r.dfs_ms << ',' << row.r.phases << ',' << row.r.bfs_ms / p << ','
+            << row.r.dfs_ms / p << ',' << (row.agree ? "true" : "false") << '\n';
+    }
+}
+
+void writeJSON(const string &path, const vector<Row> &rows) {
+    ofstream out(path);
+    out << "[\n";
+    for (size_t i = 0; i < rows.size(); i++) {
+        auto &row = rows[i];
+        int p = max(1, row.r.phases);
+        out << "  {\"graph\": \"" << row.graph << "\", \"V\": " << row.V << ", \"E\": " << row.E
+            << ", \"solver\": \"" << row.solver << "\", \"threads\": " << row.threads
+            << ", \"run\": " << row.run << ", \"flow\": " << row.r.flow
+            << ", \"build_ms\": " << row.r.build_ms << ", \"solve_ms\": " << row.r.solve_ms
+            << ", \"bfs_ms\": " << row.r.bfs_ms << ", \"dfs_ms\": " << row.r.dfs_ms
+            << ", \"phases\": " << row.r.phases << ", \"bfs_ms_per_phase\": " << row.r.bfs_ms / p
+            << ", \"dfs_ms_per_phase\": " << row.r.dfs_ms / p
+            << ", \"agree\": " << (row.agree ? "true" : "false")
+            << (row.r.stats.empty() ? "" : ", \"stats\": " + row.r.stats) << "}"
+            << (i + 1 < rows.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+}
+
+int main(int argc, char* argv[]) {
+    int runs = 3, batch = 0, incremental = 0;
+    int threads = max(1, (int)thread::hardware_concurrency());
+    string csv_path, json_path;
+    set<string> only;
+    vector<string> dimacs_paths;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string val = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--runs") {
+            runs = stoi(val); i++;
+        } else if (arg == "--threads") {
+            threads = stoi(val); i++;
+        } else if (arg == "--csv") {
+            csv_path = val; i++;
+        } else if (arg == "--json") {
+            json_path = val; i++;
+        } else if (arg == "--dimacs") {
+            dimacs_paths.push_back(val); i++;
+        } else if (arg == "--batch") {
+            batch = stoi(val); i++;
+        } else if (arg == "--incremental") {
+            incremental = stoi(val); i++;
+        } else if (arg == "--solvers") {
+            stringstream ss(val);
+            for (string name; getline(ss, name, ',');)
+                only.insert(name);
+            i++;
+        } else {
+            cerr << "usage: benchmark [--runs N] [--threads N] [--solvers a,b,...] [--csv FILE] [--json FILE] [--dimacs FILE]... [--batch N] [--incremental N]" << endl;
+            return 2;
+        }
+    }
+
+    vector<Instance> graphs;
+    graphs.push_back(instance(ChainGraph{10000, 1}));
+    graphs.push_back(instance(ChainGraph{100000, 2}));
+    graphs.push_back(instance(RandomGraph{20000, 100000, 100, 3}));
+    graphs.push_back(instance(RandomGraph{2000, 200000, 1000, 4}));
+    graphs.push_back(instance(LayeredGraph{200, 500, 3, 100, 5}));
+    graphs.push_back(instance(GridGraph{300, 300, 1, 100, 6}));
+    graphs.push_back(instance(GridGraph{40, 40, 40, 100, 7}));
+    graphs.push_back(instance(RMATGraph{16, 500000, 0.57, 0.19, 0.19, 100, 8}));
+    graphs.push_back(instance(BipartiteGraph{20000, 20000, 200000, 100, 9}));
+    graphs.push_back(instance(AKGraph{2000}));
+    graphs.push_back(instance(GenrmfGraph{20, 50, 1, 100, 10}));
+    graphs.push_back(instance(WashingtonRLG{1000, 100, 10000, 11}));
+    graphs.push_back(instance(GridGraph{100, 100, 1, 1000000, 12}));  // wide capacity range
+    graphs.push_back(instance(SegmentationGraph{400, 300, 4, 100, 13}));
+    graphs.push_back(instance(SegmentationGraph{400, 300, 8, 100, 14}));
+
+    if (!dimacs_paths.empty()) {
+        WorkerPool pool(threads);
+        for (auto &path : dimacs_paths) {
+            auto start = chrono::steady_clock::now();
+            try {
+                DimacsInstance<> d = readDimacs(path, pool);
+                graphs.push_back({path, d.V, d.s, d.t, move(d.edges)});
+            } catch (const exception &e) {
+                cerr << e.what() << endl;
+                return 2;
+            }
+            cout << "Loaded " << path << " in " << msSince(start) << " ms" << endl;
+        }
+    }
+
+    vector<SolverEntry> solvers;
+    for (auto &entry : registeredSolvers())
+        if (only.empty() || only.count(entry.name))
+            solvers.push_back(entry);
+
+    cout << "Using " << threads << " threads, " << runs << " runs per solver." << endl;
+    vector<Row> rows;
+    bool all_agree = true;
+    for (auto &in : graphs) {
+        cout << "\nGraph " << in.name << " (V = " << in.V << ", E = " << in.edges.size() << ")" << endl;
+        long long expected = -1;
+        for (auto &entry : solvers) {
+            for (int run = 0; run < runs; run++) {
+                RunResult r = entry.run(in, threads);
+                if (expected == -1)
+                    expected = r.flow;
+                bool agree = r.flow == expected;
+                all_agree = all_agree && agree;
+                rows.push_back({in.name, entry.name, in.V, in.edges.size(),
+                                entry.parallel ? threads : 1, run, r, agree});
+                cout << "  " << left << setw(30) << entry.name << right
+                     << " flow " << setw(10) << r.flow
+                     << "  build " << fixed << setprecision(2) << setw(9) << r.build_ms << " ms"
+                     << "  solve " << setw(9) << r.solve_ms << " ms"
+                     << "  bfs " << setw(9) << r.bfs_ms << " ms"
+                     << "  dfs " << setw(9) << r.dfs_ms << " ms"
+                     << "  phases " << setw(6) << r.phases
+                     << (agree ? "" : "  MISMATCH") << defaultfloat << endl;
+            }
+        }
+    }
+
+    if (batch > 0)
+        all_agree = runBatch(batch, threads) && all_agree;
+    if (incremental > 0)
+        all_agree = runIncremental(incremental, threads) && all_agree;
+
+    if (!csv_path.empty())
+        writeCSV(csv_path, rows);
+    if (!json_path.empty())
+        writeJSON(json_path, rows);
+
+    if (!all_agree) {
+        cout << "\nFlow values disagree between solvers." << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+#include <bits/stdc++.h>
+
+#include "boykovkolmogorov.h"
+#include "graphgen.h"
+
+using namespace std;
+
+int main() {
+    // 640x480 4-connected segmentation grid, seeded so every run builds the same graph. Its s and
+    // t are the generator's last two vertices, which are the engine's own terminals.
+    SegmentationGraph seg{640, 480, 4, 100, 1};
+    BoykovKolmogorov bk(seg.pixels());
+    cout << "Number of pixels: " << seg.pixels() << endl;
+    addEdges(seg, bk);
+    bk.finalize();
+
+    auto r = bk.solve();
+    int fg = 0;
+    for (int p = 0; p < seg.pixels(); p++)
+        fg += r.sourceSide(p);
+    cout << "Max Flow (Boykov-Kolmogorov Algorithm): " << r.flow << endl;
+    cout << "Foreground pixels: " << fg << endl;
+    cout << "Augmentations: " << bk.augmentations << ", adoptions: " << bk.adoptions
+         << ", freed orphans: " << bk.frees << endl;
+    return 0;
+}
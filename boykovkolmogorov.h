@@ -0,0 +1,321 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "flowgraph.h"
+#include "flowresult.h"
+using namespace std;
+
+// Boykov-Kolmogorov Algorithm (search trees that survive augmentation)
+//
+// Two search trees grow at once, S from the source over arcs with residual capacity and T into
+// the sink over arcs with residual capacity towards it. An active vertex scans its arcs and
+// claims free neighbours for its tree. When an arc joins the two trees, the path through it is
+// augmented. The arcs it saturates cut their children off from the trees. Those orphans then
+// look for a new parent in the same tree that still leads to the root, the nearest one by the
+// distance and timestamp marks of the paper. An orphan without one becomes free, and its tree
+// neighbours become active to reclaim it. The trees are never rebuilt, which is what makes BK
+// fast on grid and vision graphs: Dinic re-scans the whole graph with a BFS every phase, while
+// here each augmentation only touches the paths and the orphans it creates.
+//
+// Besides plain edges, every vertex can have terminal capacities to an implicit source and sink,
+// the data terms of a segmentation problem:
+//
+//   BoykovKolmogorov bk(pixels);
+//   bk.addTerminal(p, fg_cost, bg_cost);  // source -> p and p -> sink
+//   bk.addEdge(p, q, smoothness);
+//   bk.maxFlow();                         // source() to sink()
+//   r = bk.solve();                       // r.sourceSide(p): p is labelled foreground
+//
+// maxFlow(s, t) runs between any two vertices instead, like the other solvers. The terminals
+// are vertices V and V + 1 of the underlying graph.
+//
+// Capacity type Cap and arc index type Index as in BasicFlowGraph.
+template <class Cap = int, class Index = uint32_t>
+class BasicBoykovKolmogorov {
+    typedef BasicFlowGraph<Cap, Index> Graph;
+    typedef typename Graph::Edge Edge;
+    typedef typename Graph::Flow Flow;
+
+    enum Tree : char { FREE, SOURCE_TREE, SINK_TREE };
+
+    // parent[v] is the arc from v to its tree parent, or one of these.
+    static constexpr Index NO_PARENT = numeric_limits<Index>::max();
+    static constexpr Index ROOT = NO_PARENT - 1;
+    static constexpr Index ORPHAN = NO_PARENT - 2;
+
+    int V;
+    Graph g;
+    vector<char> tree;
+    vector<Index> parent;
+    vector<int> dist;           // distance to the root, valid while stamp[v] == time
+    vector<long long> stamp;
+    long long time = 0;
+    vector<int> active;         // FIFO of active vertices, from active_head on
+    size_t active_head = 0;
+    vector<char> is_active;
+    vector<Index> cur;          // next arc grow() looks at, so a vertex is not re-scanned per path
+    vector<int> orphans;
+
+public:
+    // Counters of the last maxFlow call.
+    long long augmentations = 0, adoptions = 0, frees = 0;
+
+    BasicBoykovKolmogorov(int V)
+        : V(V), g(V + 2), tree(V + 2), parent(V + 2), dist(V + 2), stamp(V + 2), is_active(V + 2),
+          cur(V + 2) {}
+
+    int source() const { return V; }
+    int sink() const { return V + 1; }
+
+    // Returns the new edge's id, as in Dinic.
+    size_t addEdge(int u, int v, Cap cap) {
+        return g.addEdge(u, v, cap);
+    }
+
+    // Add capacity from the source to v and from v to the sink. Calls for the same vertex add up.
+    void addTerminal(int v, Cap source_cap, Cap sink_cap) {
+        if (source_cap > 0)
+            g.addEdge(source(), v, source_cap);
+        if (sink_cap > 0)
+            g.addEdge(v, sink(), sink_cap);
+    }
+
+    // Bulk form of addEdge for loaders; takes over the list.
+    void addEdges(vector<typename Graph::InputEdge> &&edges) {
+        g.addEdges(move(edges));
+    }
+
+    // Freeze the added edges into the CSR arc array. maxFlow calls it if the caller didn't.
+    void finalize() {
+        g.finalize();
+    }
+
+    Flow maxFlow() {
+        return maxFlow(source(), sink());
+    }
+
+    Flow maxFlow(int s, int t) {
+        finalize();
+        g.resetFlow();
+        augmentations = adoptions = frees = 0;
+        fill(tree.begin(), tree.end(), FREE);
+        fill(parent.begin(), parent.end(), NO_PARENT);
+        fill(stamp.begin(), stamp.end(), 0);
+        fill(is_active.begin(), is_active.end(), 0);
+        active.clear();
+        active_head = 0;
+        orphans.clear();
+        time = 0;
+
+        tree[s] = SOURCE_TREE;
+        tree[t] = SINK_TREE;
+        parent[s] = parent[t] = ROOT;
+        dist[s] = dist[t] = 0;
+        activate(s);
+        activate(t);
+
+        Flow flow = 0;
+        int u = -1;
+        while (true) {
+            // The vertex that found the last path keeps growing before the queue moves on.
+            if (u == -1 || tree[u] == FREE) {
+                u = nextActive();
+                if (u == -1)
+                    break;
+            }
+            Index bridge = grow(u);
+            if (bridge == NO_PARENT) {
+                is_active[u] = 0;
+                u = -1;
+                continue;
+            }
+            time++;
+            flow += augment(bridge);
+            adopt();
+        }
+        return flow;
+    }
+
+    typedef BasicFlowResult<Cap, Index> Result;
+
+    // maxFlow plus the minimum cut and a view of the arc flows (see flowresult.h). At the end the
+    // source tree is closed under residual arcs, so it is exactly the source side of the cut.
+    Result solve() {
+        return solve(source(), sink());
+    }
+
+    Result solve(int s, int t) {
+        Flow flow = maxFlow(s, t);
+        return makeFlowResult(g, flow, [&](int v) { return tree[v] == SOURCE_TREE; });
+    }
+
+private:
+    int head(Index a) const { return g.arcs[a].v; }
+
+    // Residual capacity in the direction the tree of the arc's tail grows: away from the root in
+    // the source tree, towards it in the sink tree.
+    Cap treeResidual(Index a, char side) const {
+        return side == SOURCE_TREE ? g.arcs[a].res : g.arcs[g.arcs[a].rev].res;
+    }
+
+    // Also restarts v's scan: the caller may have just given one of its earlier arcs a use.
+    void activate(int v) {
+        cur[v] = g.off[v];
+        if (!is_active[v]) {
+            is_active[v] = 1;
+            active.push_back(v);
+        }
+    }
+
+    int nextActive() {
+        while (active_head < active.size()) {
+            int v = active[active_head++];
+            if (is_active[v] && tree[v] != FREE)
+                return v;
+            is_active[v] = 0;
+        }
+        active.clear();
+        active_head = 0;
+        return -1;
+    }
+
+    // Scan u's arcs: claim free neighbours and return the first arc that leads into the other
+    // tree, oriented from the source tree to the sink tree, or NO_PARENT. The scan resumes where
+    // the last path was found. An arc already passed can only become useful again when the
+    // vertex at its head is freed, and freeing activates u anew.
+    Index grow(int u) {
+        char side = tree[u];
+        for (Index &a = cur[u]; a < g.off[u + 1]; a++) {
+            if (treeResidual(a, side) == 0)
+                continue;
+            int w = head(a);
+            if (tree[w] == FREE) {
+                tree[w] = side;
+                parent[w] = g.arcs[a].rev;
+                dist[w] = dist[u] + 1;
+                stamp[w] = stamp[u];
+                activate(w);
+            } else if (tree[w] != side) {
+                return side == SOURCE_TREE ? a : g.arcs[a].rev;
+            } else if (stamp[w] <= stamp[u] && dist[w] > dist[u] + 1) {
+                // Same tree: hang w under u if that brings it closer to the root.
+                parent[w] = g.arcs[a].rev;
+                dist[w] = dist[u] + 1;
+                stamp[w] = stamp[u];
+            }
+        }
+        return NO_PARENT;
+    }
+
+    // Push the bottleneck along root -> ... -> bridge -> ... -> root. A tree arc it saturates
+    // orphans the vertex below it.
+    Flow augment(Index bridge) {
+        Cap pushed = g.arcs[bridge].res;
+        for (int v = g.arcs[g.arcs[bridge].rev].v; parent[v] != ROOT; v = head(parent[v]))
+            pushed = min(pushed, g.arcs[g.arcs[parent[v]].rev].res);
+        for (int v = head(bridge); parent[v] != ROOT; v = head(parent[v]))
+            pushed = min(pushed, g.arcs[parent[v]].res);
+
+        g.arcs[bridge].res -= pushed;
+        g.arcs[g.arcs[bridge].rev].res += pushed;
+        for (int v = g.arcs[g.arcs[bridge].rev].v; parent[v] != ROOT;) {
+            Index a = parent[v];
+            Edge &down = g.arcs[g.arcs[a].rev];  // parent -> v
+            down.res -= pushed;
+            g.arcs[a].res += pushed;
+            int up = head(a);
+            if (down.res == 0) {
+                parent[v] = ORPHAN;
+                orphans.push_back(v);
+            }
+            v = up;
+        }
+        for (int v = head(bridge); parent[v] != ROOT;) {
+            Index a = parent[v];
+            Edge &up_arc = g.arcs[a];  // v -> parent
+            up_arc.res -= pushed;
+            g.arcs[up_arc.rev].res += pushed;
+            int up = up_arc.v;
+            if (up_arc.res == 0) {
+                parent[v] = ORPHAN;
+                orphans.push_back(v);
+            }
+            v = up;
+        }
+        augmentations++;
+        return pushed;
+    }
+
+    // Distance from w to its root, or -1 if the way up passes an orphan. Marks every vertex on
+    // the way with its distance at the current time, so later walks stop early.
+    int rootDistance(int w) {
+        int d = 0, j = w;
+        while (stamp[j] != time) {
+            Index p = parent[j];
+            if (p == ROOT) {
+                stamp[j] = time;
+                dist[j] = 0;
+                break;
+            }
+            if (p == ORPHAN || p == NO_PARENT)
+                return -1;
+            d++;
+            j = head(p);
+        }
+        d += dist[j];
+        for (int k = w, dk = d; stamp[k] != time; k = head(parent[k]), dk--) {
+            stamp[k] = time;
+            dist[k] = dk;
+        }
+        return d;
+    }
+
+    void adopt() {
+        for (size_t i = 0; i < orphans.size(); i++) {
+            int v = orphans[i];
+            char side = tree[v];
+            Index best = NO_PARENT;
+            int best_dist = INT_MAX;
+            for (Index a = g.off[v]; a < g.off[v + 1]; a++) {
+                int w = head(a);
+                // A parent w must still feed v: residual w -> v in S, v -> w in T.
+                if (tree[w] != side || treeResidual(g.arcs[a].rev, side) == 0)
+                    continue;
+                int d = rootDistance(w);
+                if (d != -1 && d < best_dist) {
+                    best_dist = d;
+                    best = a;
+                }
+            }
+            if (best != NO_PARENT) {
+                parent[v] = best;
+                stamp[v] = time;
+                dist[v] = best_dist + 1;
+                adoptions++;
+                continue;
+            }
+
+            // No way back to the root: free v. Neighbours that could reclaim it become active,
+            // and its children become orphans in turn.
+            for (Index a = g.off[v]; a < g.off[v + 1]; a++) {
+                int w = head(a);
+                if (tree[w] != side)
+                    continue;
+                if (treeResidual(g.arcs[a].rev, side) > 0)
+                    activate(w);
+                Index p = parent[w];
+                if (p != ROOT && p != ORPHAN && p != NO_PARENT && head(p) == v) {
+                    parent[w] = ORPHAN;
+                    orphans.push_back(w);
+                }
+            }
+            tree[v] = FREE;
+            parent[v] = NO_PARENT;
+            is_active[v] = 0;
+            frees++;
+        }
+        orphans.clear();
+    }
+};
+
+typedef BasicBoykovKolmogorov<> BoykovKolmogorov;
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "flowgraph.h"
+#include "mappedfile.h"
+#include "workerpool.h"
+
+using namespace std;
+
+// ---------------- DIMACS Max-Flow Reader ----------------
+// Loads a DIMACS .max file:
+//
+//   c comment
+//   p max <nodes> <arcs>
+//   n <id> s
+//   n <id> t
+//   a <u> <v> <cap>
+//
+// The file is memory-mapped and cut into newline-aligned chunks that the pool parses in parallel.
+// Pass one counts the arc lines of every chunk and picks up the p/n lines. A prefix sum over
+// the counts gives each chunk its slot in a single edge array. Pass two parses the arcs straight
+// into that slot, so no per-edge push_back happens and no temporary per-chunk lists are built.
+// Vertex ids become 0-based and capacities are read as integers into Cap. Malformed input, or a
+// capacity that does not fit in Cap, throws runtime_error naming the file and line.
+//
+//   DimacsInstance<> in = readDimacs(path, pool);
+//   Dinic dinic(in.V);
+//   dinic.addEdges(move(in.edges));
+
+template <class Cap = int>
+using DimacsInstance = FlowInstance<Cap>;
+
+namespace dimacs_detail {
+
+// Parse a non-negative integer after optional blanks; false if there is none or it does not
+// fit in a long long.
+inline bool parseNumber(const char *&p, const char *end, long long &out) {
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    if (p == end || *p < '0' || *p > '9')
+        return false;
+    long long x = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        int d = *p++ - '0';
+        if (x > (LLONG_MAX - d) / 10)
+            return false;
+        x = x * 10 + d;
+    }
+    out = x;
+    return true;
+}
+
+inline bool skipWord(const char *&p, const char *end, const char *word) {
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    size_t n = strlen(word);
+    if ((size_t)(end - p) < n || memcmp(p, word, n) != 0)
+        return false;
+    p += n;
+    return true;
+}
+
+// Only blanks (or a '\r' from CRLF files) may follow the last field.
+inline bool atLineEnd(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+    return p == end;
+}
+
+struct Chunk {
+    size_t begin, end;
+    size_t arcs = 0;
+    long long nodes = -1, declared_arcs = -1;
+    long long s = -1, t = -1;
+    size_t error = SIZE_MAX;  // file offset of the first bad line
+    string what;
+};
+
+// Call f(line_begin, line_end) for every line of [begin, end).
+template <class F>
+void forLines(const char *data, size_t begin, size_t end, F &&f) {
+    const char *p = data + begin, *stop = data + end;
+    while (p < stop) {
+        const char *nl = (const char*)memchr(p, '\n', stop - p);
+        const char *line_end = nl ? nl : stop;
+        if (!f(p, line_end))
+            return;
+        p = line_end + 1;
+    }
+}
+
+}  // namespace dimacs_detail
+
+template <class Cap = int>
+DimacsInstance<Cap> readDimacs(const string &path, WorkerPool &pool) {
+    using namespace dimacs_detail;
+    MappedFile file(path);
+    const char *data = file.data();
+    size_t size = file.size();
+
+    // Newline-aligned chunks, a few per worker for balance but no smaller than 1 MiB.
+    size_t num_chunks = min((size_t)pool.size() * 4, max((size_t)1, size >> 20));
+    vector<Chunk> chunks(num_chunks);
+    for (size_t i = 0; i < num_chunks; i++) {
+        size_t b = size * i / num_chunks;
+        if (i > 0) {
+            const char *nl = (const char*)memchr(data + b, '\n', size - b);
+            b = nl ? nl - data + 1 : size;
+        }
+        chunks[i].begin = b;
+    }
+    for (size_t i = 0; i < num_chunks; i++)
+        chunks[i].end = i + 1 < num_chunks ? max(chunks[i].begin, chunks[i + 1].begin) : size;
+
+    auto fail = [&](Chunk &c, const char *line, const string &what) {
+        c.error = line - data;
+        c.what = what;
+        return false;
+    };
+
+    // Pass 1: count arc lines, read the problem and terminal lines.
+    pool.run((int)num_chunks, [&](int i, int) {
+        Chunk &c = chunks[i];
+        forLines(data, c.begin, c.end, [&](const char *p, const char *end) {
+            const char *q = p + 1;
+            long long x, y;
+            switch (p < end ? *p : 'c') {
+            case 'a':
+                c.arcs++;
+                return true;
+            case 'c': case '\r':
+                return true;
+            case 'p':
+                if (!skipWord(q, end, "max") || !parseNumber(q, end, x) || !parseNumber(q, end, y) ||
+                    !atLineEnd(q, end) || x <= 0 || x > INT_MAX)
+                    return fail(c, p, "bad problem line");
+                c.nodes = x;
+                c.declared_arcs = y;
+                return true;
+            case 'n':
+                if (!parseNumber(q, end, x))
+                    return fail(c, p, "bad node line");
+                if (skipWord(q, end, "s") && atLineEnd(q, end))
+                    c.s = x;
+                else if (skipWord(q, end, "t") && atLineEnd(q, end))
+                    c.t = x;
+                else
+                    return fail(c, p, "bad node line");
+                return true;
+            default:
+                return fail(c, p, "unknown line type");
+            }
+        });
+    });
+
+    auto report = [&](size_t offset, const string &what) {
+        size_t line = 1 + count(data, data + offset, '\n');
+        throw runtime_error(path + ":" + to_string(line) + ": " + what);
+    };
+
+    DimacsInstance<Cap> in;
+    long long nodes = -1, declared_arcs = -1, s = -1, t = -1;
+    vector<size_t> first(num_chunks + 1, 0);
+    for (size_t i = 0; i < num_chunks; i++) {
+        Chunk &c = chunks[i];
+        if (c.error != SIZE_MAX)
+            report(c.error, c.what);
+        if (c.nodes != -1) {
+            if (nodes != -1)
+                throw runtime_error(path + ": more than one problem line");
+            nodes = c.nodes;
+            declared_arcs = c.declared_arcs;
+        }
+        if (c.s != -1)
+            s = c.s;
+        if (c.t != -1)
+            t = c.t;
+        first[i + 1] = first[i] + c.arcs;
+    }
+    if (nodes == -1)
+        throw runtime_error(path + ": missing 'p max' line");
+    if (s < 1 || s > nodes || t < 1 || t > nodes || s == t)
+        throw runtime_error(path + ": missing or invalid source/sink lines");
+    if ((long long)first[num_chunks] != declared_arcs)
+        throw runtime_error(path + ": problem line declares " + to_string(declared_arcs) +
+                            " arcs, file has " + to_string(first[num_chunks]));
+
+    in.V = (int)nodes;
+    in.s = (int)s - 1;
+    in.t = (int)t - 1;
+    in.edges.resize(first[num_chunks]);
+
+    // Pass 2: parse every chunk's arcs into its slot of the edge array.
+    FlowInputEdge<Cap> *out = in.edges.data();
+    const long double max_cap = numeric_limits<Cap>::max();
+    pool.run((int)num_chunks, [&](int i, int) {
+        Chunk &c = chunks[i];
+        size_t k = first[i];
+        forLines(data, c.begin, c.end, [&](const char *p, const char *end) {
+            if (p == end || *p != 'a')
+                return true;
+            const char *q = p + 1;
+            long long u, v, cap;
+            if (!parseNumber(q, end, u) || !parseNumber(q, end, v) || !parseNumber(q, end, cap) ||
+                !atLineEnd(q, end))
+                return fail(c, p, "bad arc line");
+            if (u < 1 || u > nodes || v < 1 || v > nodes)
+                return fail(c, p, "arc endpoint out of range");
+            if ((long double)cap > max_cap)
+                return fail(c, p, "arc capacity does not fit the capacity type");
+            out[k++] = {(int)u - 1, (int)v - 1, (Cap)cap};
+            return true;
+        });
+    });
+    for (auto &c : chunks)
+        if (c.error != SIZE_MAX)
+            report(c.error, c.what);
+    return in;
+}
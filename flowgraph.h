@@ -0,0 +1,775 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <stdexcept>
+
+#include "mappedfile.h"
+#include "workerpool.h"
+
+using namespace std;
+
+// Contiguous array that either owns its elements or views memory owned elsewhere, such as a
+// mapped graph snapshot. Copying always produces an owning array.
+//
+// An owning array can also sit in an UntouchedRegion (see numa.h), zeroed but with no page
+// placed yet, so the threads that first write it decide which NUMA node each part lives on.
+template <class T>
+class GraphArray {
+public:
+    GraphArray() {}
+    GraphArray(const GraphArray &o) : own(o.begin(), o.end()), ptr(own.data()), len(own.size()) {}
+    GraphArray& operator=(const GraphArray &o) {
+        if (this != &o) {
+            own.assign(o.begin(), o.end());
+            ptr = own.data();
+            len = own.size();
+        }
+        return *this;
+    }
+
+    // Own n value-initialised elements.
+    void resize(size_t n) {
+        own.assign(n, T());
+        region.reset();
+        ptr = own.data();
+        len = n;
+    }
+
+    // Own n zeroed elements in untouched memory. Only for types whose zero bytes are their
+    // value-initialised state.
+    void allocateUntouched(size_t n) {
+        vector<T>().swap(own);
+        region = make_shared<UntouchedRegion>(n * sizeof(T));
+        ptr = (T*)region->data();
+        len = n;
+    }
+
+    // View n elements at p without taking ownership.
+    void view(T *p, size_t n) {
+        vector<T>().swap(own);
+        region.reset();
+        ptr = p;
+        len = n;
+    }
+
+    // Exchange contents with o. Owned storage moves with its array, so views stay valid.
+    void swap(GraphArray &o) {
+        own.swap(o.own);
+        region.swap(o.region);
+        std::swap(ptr, o.ptr);
+        std::swap(len, o.len);
+    }
+
+    T& operator[](size_t i) { return ptr[i]; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+    T* begin() { return ptr; }
+    T* end() { return ptr + len; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + len; }
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+
+private:
+    vector<T> own;
+    shared_ptr<UntouchedRegion> region;
+    T *ptr = nullptr;
+    size_t len = 0;
+};
+
+// Type flow totals and excesses are kept in: long long for integer capacities, double for
+// floating-point ones, so a sum of many arc capacities cannot overflow the capacity type.
+template <class Cap>
+using FlowSum = typename conditional<is_floating_point<Cap>::value, double, long long>::type;
+
+// An input edge as staged before finalize().
+template <class Cap>
+struct FlowInputEdge {
+    int u, v;
+    Cap cap;
+};
+
+// A whole max-flow problem: vertex count, terminals and edge list.
+template <class Cap = int>
+struct FlowInstance {
+    int V = 0, s = -1, t = -1;
+    vector<FlowInputEdge<Cap>> edges;
+};
+
+// Relaxed (by default) atomic access to plain memory shared between solver threads. The
+// generic builtins also cover floating-point capacities, where add becomes a CAS loop.
+template <class T>
+T atomicLoad(const T &x, int order = __ATOMIC_RELAXED) {
+    T r;
+    __atomic_load(&x, &r, order);
+    return r;
+}
+
+template <class T>
+void atomicAdd(T &x, T d, int order = __ATOMIC_RELAXED) {
+    if constexpr (is_integral<T>::value) {
+        __atomic_fetch_add(&x, d, order);
+    } else {
+        T cur = atomicLoad(x), next;
+        do {
+            next = cur + d;
+        } while (!__atomic_compare_exchange(&x, &cur, &next, true, order, __ATOMIC_RELAXED));
+    }
+}
+
+template <class T>
+void atomicSub(T &x, T d, int order = __ATOMIC_RELAXED) {
+    if constexpr (is_integral<T>::value) {
+        __atomic_fetch_sub(&x, d, order);
+    } else {
+        atomicAdd(x, -d, order);
+    }
+}
+
+// ---------------- Frozen CSR Residual Graph ----------------
+// Edges are staged by addEdge() and frozen by finalize() into one contiguous arc array.
+// The arcs of vertex u live in arcs[off[u] .. off[u + 1]), in the same order the old
+// per-vertex vectors had them, and every arc stores the index of its reverse arc in
+// that same array, so bfs/dfs scan memory in order instead of chasing one heap block
+// per vertex.
+//
+// Cap is the capacity type (uint8_t, uint16_t, int, int64_t, double, ...) and Index the type of
+// arc offsets, heads and reverse-arc indices (uint32_t, or uint64_t past 2^32 arcs). An arc stores
+// only its residual capacity; the capacity it was added with lives in the separate 'cap' array
+// that the hot loops never touch, and flow(a) = cap[a] - arcs[a].res is rebuilt on demand. With
+// int capacities and uint32_t indices an arc is 12 bytes instead of 16. Every addEdge gets its own
+// reverse arc of capacity 0, so a residual never exceeds the larger capacity of its pair and
+// always fits in Cap.
+//
+// The first finalize() (and assign()) of a large edge list builds the arrays on a worker pool: the
+// solver's own if it passes one, a temporary one otherwise. The result is the same graph the
+// sequential build makes, arc for arc. Smaller lists, and every later rebuild by finalize(), go
+// through the sequential merge. Either way, when finalize() or assign() is given a pool pinned
+// across NUMA nodes, the arcs and capacities of each node's vertices (see NumaPartition) are
+// placed in that node's memory; without one they land wherever the building thread runs.
+//
+// Edges are numbered in the order they were added, and edge_arc maps each id to its forward arc.
+// A finalized graph still accepts updates that keep the current flow: setCapacity raises or
+// lowers an edge, removeEdge drops it, and addEdge stages new edges that the next finalize()
+// merges in. The merge carries every arc's flow over, and removed edges are compacted away there
+// or once enough of them pile up. Lowering an edge below its flow cuts the flow down to the new
+// capacity, which leaves an excess at the tail and a deficit at the head. repairFlow settles them
+// before the next solve. Each excess is rerouted along a residual path to the nearest deficit, s
+// or t, and each deficit left over is refilled from the nearest of s and t. The searches start at
+// the changed edge and stop at the first vertex that takes the flow, so they stay local.
+//
+// A finalized graph can be saved as a binary snapshot and later opened in place: the offsets,
+// arcs and capacities are mapped copy-on-write straight from the file, so the solver starts
+// without parsing or rebuilding anything and its flow updates never touch the file. Snapshot
+// layout, version 3:
+//
+//   SnapshotHeader                 128 bytes
+//   Index off[V + 1]               at header.off_pos, 64-byte aligned
+//   Edge  arcs[header.arcs]        at header.arcs_pos, 64-byte aligned, residuals = capacities
+//   Cap   cap[header.arcs]         at header.cap_pos, 64-byte aligned
+//   Index edge_arc[header.edges]   at header.edge_pos, 64-byte aligned
+//
+// Everything is in the writing machine's byte order. A snapshot is only opened by a graph with the
+// same Cap and Index types, byte order and vertex count.
+template <class Cap = int, class Index = uint32_t>
+class BasicFlowGraph {
+public:
+    typedef FlowSum<Cap> Flow;
+    typedef FlowInputEdge<Cap> InputEdge;
+
+    struct Edge {
+        Index v, rev;  // head, index of the reverse arc
+        Cap res;       // residual capacity
+    };
+
+    struct SnapshotHeader {
+        char magic[8];        // "FLOWCSR"
+        uint32_t version;
+        uint32_t byte_order;  // SNAPSHOT_BYTE_ORDER as written by the saving machine
+        uint32_t edge_size;   // sizeof(Edge)
+        uint32_t index_size;  // sizeof(Index)
+        uint32_t cap_size;    // sizeof(Cap)
+        uint32_t cap_kind;    // capKind()
+        uint64_t vertices, arcs;
+        uint64_t off_pos, arcs_pos, cap_pos;
+        uint64_t edges, edge_pos;
+        uint64_t unused[5];
+    };
+
+    static const uint32_t SNAPSHOT_VERSION = 3;
+    static const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+    static const Index NO_ARC = numeric_limits<Index>::max();  // edge_arc of a removed edge
+    static const size_t PARALLEL_BUILD_EDGES = 1 << 20;  // smallest first build done in parallel
+
+    int V;
+    GraphArray<Index> off;  // V + 1 offsets into arcs
+    GraphArray<Edge> arcs;  // forward and reverse arcs, grouped by tail vertex
+    GraphArray<Cap> cap;    // capacity each arc was added with, 0 for reverse arcs
+    GraphArray<Index> edge_arc;  // forward arc of every finalized edge id, NO_ARC once removed
+
+    BasicFlowGraph(int V) : V(V) {
+        off.resize(V + 1);
+    }
+
+    // Stage an edge from u to v with capacity cap and return its id. Edges added to a finalized
+    // graph join it at the next finalize().
+    size_t addEdge(int u, int v, Cap cap) {
+        pending.push_back({u, v, cap});
+        return edge_arc.size() + pending.size() - 1;
+    }
+
+    // Stage a whole edge list at once; the edges get consecutive ids. The first batch is
+    // adopted without copying, so a loader that parsed straight into one array hands it over
+    // for free.
+    void addEdges(vector<InputEdge> &&edges) {
+        if (pending.empty())
+            pending.swap(edges);
+        else
+            pending.insert(pending.end(), edges.begin(), edges.end());
+        vector<InputEdge>().swap(edges);
+    }
+
+    bool finalized() const { return frozen && pending.empty(); }
+
+    // Number of edge ids handed out so far, removed edges included.
+    size_t edges() const { return edge_arc.size() + pending.size(); }
+
+    // Times the CSR arrays were built, merged or mapped from a snapshot. Anything a solver
+    // derives from the offsets is stale once this has moved on.
+    size_t builds() const { return build_count; }
+
+    // Build the CSR arrays from the staged edges: count degrees, prefix-sum them into
+    // offsets, then scatter each edge and its 0-capacity reverse arc. On a finalized graph
+    // it merges newly staged edges the same way, after the arcs already there, and drops
+    // removed edges; the flow on every surviving arc is kept. Otherwise it is a no-op.
+    // 'pool' is used for a first build of at least PARALLEL_BUILD_EDGES edges (see build).
+    void finalize(WorkerPool *pool = nullptr) {
+        if (frozen && pending.empty() && removed.size() * 16 <= arcs.size())
+            return;
+        merge(pending, pool);
+        vector<InputEdge>().swap(pending);
+    }
+
+    // Turn this into the finalized graph of V = n vertices and 'edges', dropping everything it
+    // held. The arrays keep their allocations, so recycling one graph (and the solver around
+    // it) across many instances stops allocating once it has seen the largest.
+    void assign(int n, const vector<InputEdge> &edges, WorkerPool *pool = nullptr) {
+        V = n;
+        frozen = false;
+        pending.clear();
+        removed.clear();
+        backing.reset();
+        flow_s = flow_t = -1;
+        imbalance.clear();
+        unbalanced.clear();
+        parent.clear();
+        seen.clear();
+        off.resize(0);
+        arcs.resize(0);
+        cap.resize(0);
+        edge_arc.resize(0);
+        merge(edges, pool);
+    }
+
+    // Flow on arc a; negative on the reverse arc of an edge that carries flow.
+    Flow flow(Index a) const {
+        return (Flow)cap[a] - (Flow)arcs[a].res;
+    }
+
+    // Net flow out of u: the flow value when u is the source.
+    Flow outflow(int u) const {
+        Flow f = 0;
+        for (Index a = off[u]; a < off[u + 1]; a++)
+            f += flow(a);
+        return f;
+    }
+
+    // Remove all flow: every residual goes back to its capacity.
+    void resetFlow() {
+        for (size_t a = 0; a < arcs.size(); a++)
+            arcs[a].res = cap[a];
+        for (int u : unbalanced)
+            imbalance[u] = 0;
+        unbalanced.clear();
+        flow_s = flow_t = -1;
+    }
+
+    // ---------------- Incremental Updates ----------------
+    // Capacity and flow of an edge by id; both are 0 once it is removed.
+    Cap edgeCapacity(size_t id) const {
+        if (id >= edge_arc.size())
+            return pending[id - edge_arc.size()].cap;
+        return edge_arc[id] == NO_ARC ? 0 : cap[edge_arc[id]];
+    }
+
+    Flow edgeFlow(size_t id) const {
+        return id >= edge_arc.size() || edge_arc[id] == NO_ARC ? 0 : flow(edge_arc[id]);
+    }
+
+    // Change the capacity of an edge, keeping as much of its flow as still fits. Flow above
+    // the new capacity is taken off the edge and left to repairFlow.
+    void setCapacity(size_t id, Cap c) {
+        assert(c >= 0);
+        if (id >= edge_arc.size()) {
+            pending[id - edge_arc.size()].cap = c;
+            return;
+        }
+        Index a = edge_arc[id];
+        assert(a != NO_ARC);
+        Edge &e = arcs[a], &r = arcs[e.rev];
+        Flow f = flow(a);
+        if (f > (Flow)c) {
+            // The reverse arc's residual is the edge's flow; the forward arc ends up saturated.
+            addImbalance(r.v, f - (Flow)c);
+            addImbalance(e.v, (Flow)c - f);
+            r.res = c;
+            e.res = 0;
+        } else {
+            e.res = (Cap)((Flow)c - f);
+        }
+        cap[a] = c;
+    }
+
+    // Take an edge out of the graph, returning its flow like a capacity of 0 would. Its arcs
+    // stay in place with no residual until a later finalize() compacts them.
+    void removeEdge(size_t id) {
+        if (id >= edge_arc.size())
+            finalize();
+        assert(edge_arc[id] != NO_ARC);
+        setCapacity(id, 0);
+        removed.push_back(edge_arc[id]);
+        edge_arc[id] = NO_ARC;
+    }
+
+    // Make the kept flow a valid s-t flow again before a solve continues from it. A flow kept
+    // for other terminals is dropped instead.
+    void repairFlow(int s, int t) {
+        if (s != flow_s || t != flow_t) {
+            if (flow_s != -1)
+                resetFlow();
+            flow_s = s;
+            flow_t = t;
+            return;
+        }
+        if (unbalanced.empty())
+            return;
+        if (parent.size() != (size_t)V) {
+            parent.assign(V, 0);
+            seen.assign(V, 0);
+        }
+
+        // Excess goes forward to the closest vertex that can absorb it.
+        for (int u : unbalanced) {
+            while (u != s && u != t && imbalance[u] > 0) {
+                int z = residualSearch(u, false, [&](int x) {
+                    return x == s || x == t || imbalance[x] < 0;
+                });
+                if (z < 0)
+                    break;
+                Flow d = imbalance[u];
+                if (z != s && z != t)
+                    d = min(d, -imbalance[z]);
+                d = augmentPath(u, z, false, d);
+                imbalance[u] -= d;
+                if (z != s && z != t)
+                    imbalance[z] += d;
+            }
+        }
+        // Deficits are refilled from whichever terminal is closer.
+        for (int v : unbalanced) {
+            while (v != s && v != t && imbalance[v] < 0) {
+                int z = residualSearch(v, true, [&](int x) { return x == s || x == t; });
+                if (z < 0)
+                    break;
+                imbalance[v] += augmentPath(v, z, true, -imbalance[v]);
+            }
+        }
+        for (int u : unbalanced)
+            imbalance[u] = 0;
+        unbalanced.clear();
+    }
+
+    // Write the finalized graph as a snapshot, with all flow removed. Throws on I/O errors.
+    void saveSnapshot(const string &path) const {
+        assert(finalized());
+        SnapshotHeader h = {};
+        memcpy(h.magic, "FLOWCSR", 8);
+        h.version = SNAPSHOT_VERSION;
+        h.byte_order = SNAPSHOT_BYTE_ORDER;
+        h.edge_size = sizeof(Edge);
+        h.index_size = sizeof(Index);
+        h.cap_size = sizeof(Cap);
+        h.cap_kind = capKind();
+        h.vertices = V;
+        h.arcs = arcs.size();
+        h.off_pos = alignUp(sizeof(h));
+        h.arcs_pos = alignUp(h.off_pos + (V + 1) * sizeof(Index));
+        h.cap_pos = alignUp(h.arcs_pos + h.arcs * sizeof(Edge));
+        h.edges = edge_arc.size();
+        h.edge_pos = alignUp(h.cap_pos + h.arcs * sizeof(Cap));
+
+        unique_ptr<FILE, int (*)(FILE*)> f(fopen(path.c_str(), "wb"), fclose);
+        if (!f)
+            throw runtime_error(path + ": cannot create");
+        uint64_t written = 0;
+        auto put = [&](const void *p, uint64_t bytes) {
+            return fwrite(p, 1, bytes, f.get()) == bytes && (written += bytes, true);
+        };
+        auto padTo = [&](uint64_t pos) {
+            static const char zeros[64] = {};
+            return put(zeros, pos - written);
+        };
+        bool ok = put(&h, sizeof(h)) && padTo(h.off_pos) &&
+                  put(off.data(), (V + 1) * sizeof(Index)) && padTo(h.arcs_pos);
+        vector<Edge> block;
+        for (size_t i = 0; ok && i < arcs.size(); i += block.size()) {
+            block.assign(arcs.begin() + i, arcs.begin() + min(arcs.size(), i + (1 << 16)));
+            for (size_t k = 0; k < block.size(); k++)
+                block[k].res = cap[i + k];
+            ok = put(block.data(), block.size() * sizeof(Edge));
+        }
+        ok = ok && padTo(h.cap_pos) && put(cap.data(), h.arcs * sizeof(Cap)) &&
+             padTo(h.edge_pos) && put(edge_arc.data(), h.edges * sizeof(Index));
+        if (!ok || fclose(f.release()) != 0)
+            throw runtime_error(path + ": write failed");
+    }
+
+    // Vertex count recorded in a snapshot, so the caller can size a solver before opening it.
+    static int snapshotVertices(const string &path) {
+        return (int)readSnapshotHeader(path).vertices;
+    }
+
+    // Map a snapshot copy-on-write as this graph's finalized arrays. Apart from one O(V + E)
+    // validation pass over the mapped arrays this costs no more than the page faults. The graph
+    // must be empty and have the snapshot's vertex count. Throws if the file is not a compatible
+    // snapshot or its arrays do not form a consistent graph.
+    void openSnapshot(const string &path) {
+        assert(!frozen && pending.empty());
+        SnapshotHeader h = readSnapshotHeader(path);
+        if (h.vertices != (uint64_t)V)
+            throw runtime_error(path + ": snapshot has " + to_string(h.vertices) +
+                                " vertices, graph has " + to_string(V));
+        auto file = make_shared<MappedFile>(path, true);
+        // Section [pos, pos + count * size) ends by 'end', without overflowing.
+        auto fits = [](uint64_t pos, uint64_t count, size_t size, uint64_t end) {
+            return pos <= end && count <= (end - pos) / size;
+        };
+        if (h.off_pos % alignof(Index) || h.arcs_pos % alignof(Edge) || h.cap_pos % alignof(Cap) ||
+            h.edge_pos % alignof(Index) || !fits(h.off_pos, V + 1, sizeof(Index), h.arcs_pos) ||
+            !fits(h.arcs_pos, h.arcs, sizeof(Edge), h.cap_pos) ||
+            !fits(h.cap_pos, h.arcs, sizeof(Cap), h.edge_pos) ||
+            !fits(h.edge_pos, h.edges, sizeof(Index), file->size()))
+            throw runtime_error(path + ": truncated or corrupt snapshot");
+        Index *o = (Index*)(file->data() + h.off_pos);
+        checkSnapshot(path, o, (const Edge*)(file->data() + h.arcs_pos), (Index)h.arcs,
+                      (const Index*)(file->data() + h.edge_pos), h.edges);
+        off.view(o, V + 1);
+        arcs.view((Edge*)(file->data() + h.arcs_pos), h.arcs);
+        cap.view((Cap*)(file->data() + h.cap_pos), h.arcs);
+        edge_arc.view((Index*)(file->data() + h.edge_pos), h.edges);
+        backing = file;
+        frozen = true;
+        build_count++;
+    }
+
+private:
+    vector<InputEdge> pending;
+    bool frozen = false;
+    size_t build_count = 0;
+    shared_ptr<MappedFile> backing;  // keeps a mapped snapshot alive while the arrays view it
+
+    // Incremental state: terminals of the kept flow, per-vertex excess (> 0) or deficit (< 0)
+    // left by lowered edges, and scratch for the residual searches of repairFlow.
+    int flow_s = -1, flow_t = -1;
+    vector<Index> removed;  // forward arcs of removed edges not yet compacted
+    vector<Flow> imbalance;
+    vector<int> unbalanced;
+    vector<Index> parent, search_path;
+    vector<uint32_t> seen;
+    vector<int> search_queue;
+    uint32_t stamp = 0;
+
+    // Rebuild the CSR arrays from the arcs already there, minus removed edges, followed by
+    // 'edges'. An unfinalized graph has nothing to carry over and builds straight into its own
+    // storage, in parallel when the list is large.
+    void merge(const vector<InputEdge> &edges, WorkerPool *pool) {
+        if (!frozen && edges.size() >= PARALLEL_BUILD_EDGES) {
+            if (pool) {
+                build(edges, *pool);
+            } else {
+                WorkerPool local(thread::hardware_concurrency());
+                build(edges, local);
+            }
+            return;
+        }
+        size_t old_arcs = arcs.size(), old_edges = edge_arc.size();
+        vector<char> drop(old_arcs, 0);
+        for (Index a : removed)
+            drop[a] = drop[arcs[a].rev] = 1;
+
+        GraphArray<Index> new_off;
+        GraphArray<Edge> new_arcs;
+        GraphArray<Cap> new_cap;
+        GraphArray<Index> new_edge_arc;
+        if (!frozen) {
+            new_off.swap(off);
+            new_arcs.swap(arcs);
+            new_cap.swap(cap);
+            new_edge_arc.swap(edge_arc);
+        }
+        new_off.resize(V + 1);
+        for (int u = 0; frozen && u < V; u++)
+            for (Index a = off[u]; a < off[u + 1]; a++)
+                new_off[u + 1] += !drop[a];
+        for (auto &p : edges) {
+            new_off[p.u + 1]++;
+            new_off[p.v + 1]++;
+        }
+        for (int u = 0; u < V; u++)
+            new_off[u + 1] += new_off[u];
+
+        allocateArcs(new_off, new_arcs, new_cap, pool);
+        new_edge_arc.resize(old_edges + edges.size());
+        vector<Index> pos(new_off.begin(), new_off.end() - 1);
+
+        // Surviving arcs keep their order at the front of each vertex's range.
+        vector<Index> moved(old_arcs);
+        for (int u = 0; frozen && u < V; u++) {
+            for (Index a = off[u]; a < off[u + 1]; a++) {
+                if (drop[a])
+                    continue;
+                moved[a] = pos[u]++;
+                new_arcs[moved[a]] = arcs[a];
+                new_cap[moved[a]] = cap[a];
+            }
+        }
+        for (size_t a = 0; a < old_arcs; a++)
+            if (!drop[a])
+                new_arcs[moved[a]].rev = moved[arcs[a].rev];
+        for (size_t id = 0; id < old_edges; id++)
+            new_edge_arc[id] = edge_arc[id] == NO_ARC ? NO_ARC : moved[edge_arc[id]];
+
+        size_t id = old_edges;
+        for (auto &p : edges) {
+            Index a = pos[p.u]++;
+            Index b = pos[p.v]++;
+            new_arcs[a] = {(Index)p.v, b, p.cap};
+            new_arcs[b] = {(Index)p.u, a, 0};
+            new_cap[a] = p.cap;
+            new_edge_arc[id++] = a;
+        }
+
+        off.swap(new_off);
+        arcs.swap(new_arcs);
+        cap.swap(new_cap);
+        edge_arc.swap(new_edge_arc);
+        removed.clear();
+        backing.reset();
+        frozen = true;
+        build_count++;
+    }
+
+    // First build of the CSR arrays from 'edges' on the pool. The edge list is split into
+    // contiguous chunks and each chunk counts the arcs it gives every vertex into its own
+    // histogram, so counting needs no atomics. A prefix sum over vertex blocks then turns the
+    // histograms into each chunk's first slot in every vertex's range, and each chunk scatters
+    // its edges into those slots. Chunk c's arcs land after those of chunks before it, in edge
+    // order, which is exactly where the sequential build puts them, and an edge's two arcs are
+    // placed by the same task, so every reverse index is known when the arc is written. The
+    // histograms take chunks * V indices; the chunk count is capped so that stays within the
+    // size of the arc array. The arc and capacity arrays are placed by allocateArcs.
+    void build(const vector<InputEdge> &edges, WorkerPool &pool) {
+        size_t m = edges.size();
+        int chunks = (int)min<size_t>(pool.size(), max<size_t>(1, 2 * m / max(V, 1)));
+        vector<vector<Index>> slot(chunks);
+        pool.run(chunks, [&](int c, int) {
+            slot[c].assign(V, 0);
+            for (size_t i = m * c / chunks; i < m * (c + 1) / chunks; i++) {
+                slot[c][edges[i].u]++;
+                slot[c][edges[i].v]++;
+            }
+        });
+
+        off.resize(V + 1);
+        int blocks = min(pool.size() * 4, max(1, V));
+        auto blockBegin = [&](int b) { return (int)((long long)V * b / blocks); };
+        vector<Index> block_base(blocks + 1, 0);
+        pool.run(blocks, [&](int b, int) {
+            Index sum = 0;
+            for (int u = blockBegin(b); u < blockBegin(b + 1); u++)
+                for (int c = 0; c < chunks; c++)
+                    sum += slot[c][u];
+            block_base[b + 1] = sum;
+        });
+        for (int b = 0; b < blocks; b++)
+            block_base[b + 1] += block_base[b];
+        pool.run(blocks, [&](int b, int) {
+            Index base = block_base[b];
+            for (int u = blockBegin(b); u < blockBegin(b + 1); u++) {
+                off[u] = base;
+                for (int c = 0; c < chunks; c++) {
+                    Index count = slot[c][u];
+                    slot[c][u] = base;
+                    base += count;
+                }
+            }
+        });
+        off[V] = block_base[blocks];
+
+        allocateArcs(off, arcs, cap, &pool);
+        edge_arc.resize(m);
+        pool.run(chunks, [&](int c, int) {
+            vector<Index> &pos = slot[c];
+            for (size_t i = m * c / chunks; i < m * (c + 1) / chunks; i++) {
+                const InputEdge &p = edges[i];
+                Index a = pos[p.u]++;
+                Index b = pos[p.v]++;
+                arcs[a] = {(Index)p.v, b, p.cap};
+                arcs[b] = {(Index)p.u, a, 0};
+                cap[a] = p.cap;
+                edge_arc[i] = a;
+            }
+        });
+        removed.clear();
+        backing.reset();
+        frozen = true;
+        build_count++;
+    }
+
+    // Size 'to_arcs' and 'to_cap' for the o[V] arcs of offsets 'o'. On a NUMA pool they start out
+    // untouched and every node's workers zero the ranges of the node's vertices, which puts those
+    // pages on the node that will scan them, whichever thread fills them in afterwards.
+    void allocateArcs(const GraphArray<Index> &o, GraphArray<Edge> &to_arcs, GraphArray<Cap> &to_cap,
+                      WorkerPool *pool) {
+        if (!pool || pool->nodes() == 1) {
+            to_arcs.resize(o[V]);
+            to_cap.resize(o[V]);
+            return;
+        }
+        NumaPartition parts = NumaPartition::byArcs(o.data(), V, pool->nodes());
+        to_arcs.allocateUntouched(o[V]);
+        to_cap.allocateUntouched(o[V]);
+        pool->runEach([&](int w, int) {
+            int n = pool->node(w);
+            auto range = pool->nodeShare(w, o[parts.first[n]], o[parts.first[n + 1]]);
+            size_t len = range.second - range.first;
+            memset((void*)(to_arcs.data() + range.first), 0, len * sizeof(Edge));
+            memset((void*)(to_cap.data() + range.first), 0, len * sizeof(Cap));
+        });
+    }
+
+    void addImbalance(int u, Flow d) {
+        if (imbalance.empty())
+            imbalance.assign(V, 0);
+        if (imbalance[u] == 0)
+            unbalanced.push_back(u);
+        imbalance[u] += d;
+    }
+
+    // Breadth-first search of the residual graph from 'from' that stops at the first vertex
+    // 'isTarget' accepts and returns it, or -1 if none is reachable. It follows arcs with
+    // residual capacity out of each vertex, or into it when searching backward, and leaves the
+    // arc that reached each vertex in parent[], oriented the way flow would travel.
+    template <class Target>
+    int residualSearch(int from, bool backward, Target isTarget) {
+        if (++stamp == 0) {
+            fill(seen.begin(), seen.end(), 0);
+            stamp = 1;
+        }
+        search_queue.assign(1, from);
+        seen[from] = stamp;
+        for (size_t qi = 0; qi < search_queue.size(); qi++) {
+            int u = search_queue[qi];
+            for (Index a = off[u]; a < off[u + 1]; a++) {
+                const Edge &e = arcs[a];
+                if (seen[e.v] == stamp || (backward ? arcs[e.rev].res : e.res) <= 0)
+                    continue;
+                seen[e.v] = stamp;
+                parent[e.v] = backward ? e.rev : a;
+                if (isTarget((int)e.v))
+                    return e.v;
+                search_queue.push_back(e.v);
+            }
+        }
+        return -1;
+    }
+
+    // Push up to 'limit' along the path residualSearch found from 'from' to 'to' (from 'to' to
+    // 'from' when backward) and return the amount pushed.
+    Flow augmentPath(int from, int to, bool backward, Flow limit) {
+        search_path.clear();
+        for (int x = to; x != from;) {
+            Index a = parent[x];
+            search_path.push_back(a);
+            x = backward ? (int)arcs[a].v : (int)arcs[arcs[a].rev].v;
+        }
+        Cap d = (Cap)min(limit, (Flow)numeric_limits<Cap>::max());
+        for (Index a : search_path)
+            d = min(d, arcs[a].res);
+        for (Index a : search_path) {
+            arcs[a].res -= d;
+            arcs[arcs[a].rev].res += d;
+        }
+        return d;
+    }
+
+    static uint64_t alignUp(uint64_t x) {
+        return (x + 63) & ~(uint64_t)63;
+    }
+
+    // 0 signed integer, 1 unsigned integer, 2 floating point.
+    static uint32_t capKind() {
+        return is_floating_point<Cap>::value ? 2 : is_signed<Cap>::value ? 0 : 1;
+    }
+
+    // Everything the solvers index by without checking: offsets rising from 0 to the arc count,
+    // heads in range, every arc the reverse of its reverse with the head its tail, and edge
+    // arcs in range or NO_ARC.
+    void checkSnapshot(const string &path, const Index *o, const Edge *e, Index num_arcs,
+                       const Index *ea, uint64_t num_edges) const {
+        if (o[0] != 0 || o[V] != num_arcs)
+            throw runtime_error(path + ": corrupt snapshot offsets");
+        for (int u = 0; u < V; u++)
+            if (o[u] > o[u + 1])
+                throw runtime_error(path + ": corrupt snapshot offsets");
+        for (int u = 0; u < V; u++) {
+            for (Index a = o[u]; a < o[u + 1]; a++) {
+                if ((uint64_t)e[a].v >= (uint64_t)V || e[a].rev >= num_arcs ||
+                    e[e[a].rev].rev != a || (uint64_t)e[e[a].rev].v != (uint64_t)u)
+                    throw runtime_error(path + ": corrupt snapshot arcs");
+            }
+        }
+        for (uint64_t i = 0; i < num_edges; i++)
+            if (ea[i] != NO_ARC && ea[i] >= num_arcs)
+                throw runtime_error(path + ": corrupt snapshot edge ids");
+    }
+
+    static SnapshotHeader readSnapshotHeader(const string &path) {
+        unique_ptr<FILE, int (*)(FILE*)> f(fopen(path.c_str(), "rb"), fclose);
+        if (!f)
+            throw runtime_error(path + ": cannot open");
+        SnapshotHeader h;
+        if (fread(&h, sizeof(h), 1, f.get()) != 1 || memcmp(h.magic, "FLOWCSR", 8) != 0)
+            throw runtime_error(path + ": not a graph snapshot");
+        if (h.version != SNAPSHOT_VERSION)
+            throw runtime_error(path + ": unsupported snapshot version " + to_string(h.version));
+        if (h.byte_order != SNAPSHOT_BYTE_ORDER || h.edge_size != sizeof(Edge) ||
+            h.index_size != sizeof(Index) || h.cap_size != sizeof(Cap) || h.cap_kind != capKind())
+            throw runtime_error(path + ": snapshot written with a different byte order or arc layout");
+        if (h.vertices > (uint64_t)INT32_MAX || h.arcs > (uint64_t)numeric_limits<Index>::max())
+            throw runtime_error(path + ": snapshot too large for this graph's index type");
+        return h;
+    }
+};
+
+typedef BasicFlowGraph<> FlowGraph;
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <algorithm>
+
+#include "flowgraph.h"
+#include "workerpool.h"
+
+using namespace std;
+
+// ---------------- Max-Flow Results ----------------
+// What a solve leaves behind besides the flow value:
+//
+//   source_side   bitset of the vertices reachable from s in the final residual graph, the
+//                 source side of a minimum cut (bit v of word v / 64)
+//   cut_arcs      the arcs leaving the source side, grouped by tail vertex; all saturated, and
+//                 their capacities sum to the flow value
+//   arc_flows     read-only view of the flow on every arc, read from the solver's own arrays
+//
+// arc_flows is not a copy: it stays valid until the solver is changed or destroyed, and an
+// arc's index, head and tail are those of the solver's graph (head and tail go through the
+// vertex map of a reordered solve, see reorder.h).
+//
+//   Dinic::Result r = dinic.solve(s, t);
+//   for (auto a : r.cut_arcs)
+//       printf("%d -> %d\n", (int)r.arc_flows.tail(a), (int)r.arc_flows.head(a));
+
+template <class Cap = int, class Index = uint32_t>
+class ArcFlows {
+    typedef BasicFlowGraph<Cap, Index> Graph;
+    typedef typename Graph::Edge Edge;
+
+public:
+    typedef typename Graph::Flow Flow;
+
+    ArcFlows() {}
+    explicit ArcFlows(const Graph &g) : arcs(g.arcs.data()), cap(g.cap.data()), n(g.arcs.size()) {}
+
+    // Flow on arc a; negative on the reverse arc of an edge that carries flow.
+    Flow operator[](size_t a) const { return (Flow)cap[a] - (Flow)arcs[a].res; }
+    Cap capacity(size_t a) const { return cap[a]; }
+    Index head(size_t a) const { return vertex(arcs[a].v); }
+    Index tail(size_t a) const { return vertex(arcs[arcs[a].rev].v); }
+    size_t size() const { return n; }
+
+    // Report heads and tails as ids[v] instead of the graph's own v. Not copied either.
+    void mapVertices(const int *vertex_ids) { ids = vertex_ids; }
+
+private:
+    const Edge *arcs = nullptr;
+    const Cap *cap = nullptr;
+    size_t n = 0;
+    const int *ids = nullptr;
+
+    Index vertex(Index v) const { return ids ? (Index)ids[v] : v; }
+};
+
+template <class Cap = int, class Index = uint32_t>
+struct BasicFlowResult {
+    typedef typename BasicFlowGraph<Cap, Index>::Flow Flow;
+
+    Flow flow = 0;
+    vector<uint64_t> source_side;
+    vector<Index> cut_arcs;
+    ArcFlows<Cap, Index> arc_flows;
+
+    bool sourceSide(int v) const { return source_side[v >> 6] >> (v & 63) & 1; }
+};
+
+namespace flow_result_detail {
+
+// Graphs at least this large get the cut extracted on a pool even when the solver has none.
+static const size_t PARALLEL_ARCS = 1 << 20;
+
+// Pack reached(v) into the bitset and collect the arcs leaving the source side. Both split the
+// vertices into chunks of whole bitset words, so no two tasks write the same word, and the cut
+// arcs of each chunk are appended in chunk order.
+template <class Cap, class Index, class Reached>
+BasicFlowResult<Cap, Index> collect(const BasicFlowGraph<Cap, Index> &g, FlowSum<Cap> flow,
+                                    Reached reached, WorkerPool &pool) {
+    BasicFlowResult<Cap, Index> r;
+    r.flow = flow;
+    r.arc_flows = ArcFlows<Cap, Index>(g);
+    int V = g.V;
+    int words = (V + 63) / 64;
+    r.source_side.assign(words, 0);
+
+    int num_chunks = min(pool.size() * 4, max(1, (int)(g.arcs.size() >> 16)));
+    num_chunks = min(num_chunks, max(1, words));
+    int chunk_words = (words + num_chunks - 1) / num_chunks;
+    vector<vector<Index>> chunk_cut(num_chunks);
+    pool.run(num_chunks, [&](int c, int) {
+        int begin = min(V, c * chunk_words * 64), end = min(V, (c + 1) * chunk_words * 64);
+        for (int v = begin; v < end; v++)
+            if (reached(v))
+                r.source_side[v >> 6] |= (uint64_t)1 << (v & 63);
+        for (int v = begin; v < end; v++) {
+            if (!r.sourceSide(v))
+                continue;
+            for (Index a = g.off[v]; a < g.off[v + 1]; a++)
+                if (g.cap[a] > 0 && !reached((int)g.arcs[a].v))
+                    chunk_cut[c].push_back(a);
+        }
+    });
+
+    size_t total = 0;
+    for (auto &cut : chunk_cut)
+        total += cut.size();
+    r.cut_arcs.reserve(total);
+    for (auto &cut : chunk_cut)
+        r.cut_arcs.insert(r.cut_arcs.end(), cut.begin(), cut.end());
+    return r;
+}
+
+// Vertices reachable from s over arcs with residual capacity, by a level-synchronous BFS whose
+// frontier is split across the pool. A vertex is claimed by a compare-and-swap of its flag.
+template <class Cap, class Index>
+vector<char> residualReach(const BasicFlowGraph<Cap, Index> &g, int s, WorkerPool &pool) {
+    vector<char> seen(g.V, 0);
+    seen[s] = 1;
+    vector<int> frontier(1, s);
+    vector<WorkerBuffer> local_frontiers(pool.size());
+    while (!frontier.empty()) {
+        for (auto &lf : local_frontiers)
+            lf.items.clear();
+        int f_size = frontier.size();
+        int num_chunks = min(pool.size() * 4, max(1, f_size / 256));
+        int chunk_size = (f_size + num_chunks - 1) / num_chunks;
+        pool.run(num_chunks, [&](int c, int worker_id) {
+            int end = min((c + 1) * chunk_size, f_size);
+            for (int k = c * chunk_size; k < end; k++) {
+                int u = frontier[k];
+                for (Index a = g.off[u]; a < g.off[u + 1]; a++) {
+                    int w = g.arcs[a].v;
+                    if (g.arcs[a].res > 0 && !__atomic_load_n(&seen[w], __ATOMIC_RELAXED)) {
+                        char expected = 0;
+                        if (__atomic_compare_exchange_n(&seen[w], &expected, 1, false,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                            local_frontiers[worker_id].items.push_back(w);
+                    }
+                }
+            }
+        });
+        frontier.clear();
+        for (auto &lf : local_frontiers)
+            frontier.insert(frontier.end(), lf.items.begin(), lf.items.end());
+    }
+    return seen;
+}
+
+} // namespace flow_result_detail
+
+// Result of a solve whose search already marked the vertices reachable from s: Dinic's last
+// BFS, which failed to reach t. 'pool' may be null; large graphs then get a temporary one.
+template <class Cap, class Index, class Reached>
+BasicFlowResult<Cap, Index> makeFlowResult(const BasicFlowGraph<Cap, Index> &g,
+                                           FlowSum<Cap> flow, Reached reached,
+                                           WorkerPool *pool = nullptr) {
+    if (pool)
+        return flow_result_detail::collect(g, flow, reached, *pool);
+    WorkerPool local(g.arcs.size() >= flow_result_detail::PARALLEL_ARCS
+                         ? (int)thread::hardware_concurrency() : 1);
+    return flow_result_detail::collect(g, flow, reached, local);
+}
+
+// Result of a solve that left only the flow: the source side is found by a residual BFS from s.
+template <class Cap, class Index>
+BasicFlowResult<Cap, Index> makeFlowResult(const BasicFlowGraph<Cap, Index> &g,
+                                           FlowSum<Cap> flow, int s, WorkerPool *pool = nullptr) {
+    WorkerPool local(pool || g.arcs.size() < flow_result_detail::PARALLEL_ARCS
+                         ? 1 : (int)thread::hardware_concurrency());
+    WorkerPool &p = pool ? *pool : local;
+    vector<char> seen = flow_result_detail::residualReach(g, s, p);
+    return flow_result_detail::collect(g, flow, [&](int v) { return seen[v] != 0; }, p);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <chrono>
+
+using namespace std;
+
+// Build with -DFLOW_STATS to have the solvers fill in FlowStats. Without it every recording site
+// sits behind 'if constexpr (FlowStats::ENABLED)' and compiles to nothing; the struct stays so
+// code reading it builds either way.
+#ifndef FLOW_STATS
+#define FLOW_STATS 0
+#endif
+
+// ---------------- Solver Statistics ----------------
+// Counters of one maxFlow call, kept per phase. For the Dinic solvers a phase is one level graph
+// and its blocking flow. For the push-relabel solvers it is the stretch of work that ends with a
+// global relabel, the exact labelling standing in for the BFS and the discharges for the DFS.
+struct PhaseStats {
+    double bfs_ms = 0, dfs_ms = 0;
+    long long bfs_arcs = 0;   // arcs the BFS (or global relabel) scanned
+    long long dfs_arcs = 0;   // arcs the blocking flow retired by moving current-arc pointers past them
+    long long paths = 0;      // augmenting paths (Dinic)
+    long long pushes = 0, relabels = 0;  // push-relabel
+    double flow = 0;          // flow that reached t during the phase
+    int sink_level = -1;      // level of t (Dinic) or deepest exact label (push-relabel)
+};
+
+struct FlowStats {
+    static const bool ENABLED = FLOW_STATS;
+
+    double total_ms = 0;
+    double final_bfs_ms = 0;       // the last search, which proves no augmenting path is left
+    long long final_bfs_arcs = 0;
+    long long global_relabels = 0, gaps = 0, rounds = 0;  // push-relabel
+    vector<PhaseStats> phases;
+
+    void clear() { *this = FlowStats(); }
+
+    PhaseStats total() const {
+        PhaseStats sum;
+        for (auto &p : phases) {
+            sum.bfs_ms += p.bfs_ms;
+            sum.dfs_ms += p.dfs_ms;
+            sum.bfs_arcs += p.bfs_arcs;
+            sum.dfs_arcs += p.dfs_arcs;
+            sum.paths += p.paths;
+            sum.pushes += p.pushes;
+            sum.relabels += p.relabels;
+            sum.flow += p.flow;
+        }
+        sum.bfs_ms += final_bfs_ms;
+        sum.bfs_arcs += final_bfs_arcs;
+        return sum;
+    }
+
+    string json() const {
+        ostringstream out;
+        auto phase = [&](const PhaseStats &p) {
+            out << "{\"bfs_ms\": " << p.bfs_ms << ", \"dfs_ms\": " << p.dfs_ms
+                << ", \"bfs_arcs\": " << p.bfs_arcs << ", \"dfs_arcs\": " << p.dfs_arcs
+                << ", \"paths\": " << p.paths << ", \"pushes\": " << p.pushes
+                << ", \"relabels\": " << p.relabels << ", \"flow\": " << p.flow
+                << ", \"sink_level\": " << p.sink_level << "}";
+        };
+        out << "{\"enabled\": " << (ENABLED ? "true" : "false") << ", \"total_ms\": " << total_ms
+            << ", \"final_bfs_ms\": " << final_bfs_ms << ", \"final_bfs_arcs\": " << final_bfs_arcs
+            << ", \"global_relabels\": " << global_relabels << ", \"gaps\": " << gaps
+            << ", \"rounds\": " << rounds << ", \"total\": ";
+        phase(total());
+        out << ", \"phases\": [";
+        for (size_t i = 0; i < phases.size(); i++) {
+            out << (i ? ", " : "");
+            phase(phases[i]);
+        }
+        out << "]}";
+        return out.str();
+    }
+};
+
+inline double msSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Arcs out of every vertex a BFS labelled: what a full top-down BFS scans.
+template <class Graph, class Levels>
+long long labelledArcs(const Graph &g, const Levels &level) {
+    long long arcs = 0;
+    for (int u = 0; u < g.V; u++)
+        if (level[u] != -1)
+            arcs += g.off[u + 1] - g.off[u];
+    return arcs;
+}
+
+// Arcs the current-arc pointers have moved past since they were reset to the offsets.
+template <class Graph, class Pointers>
+long long retiredArcs(const Graph &g, const Pointers &ptr) {
+    long long arcs = 0;
+    for (int u = 0; u < g.V; u++)
+        arcs += ptr[u] - g.off[u];
+    return arcs;
+}
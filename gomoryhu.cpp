@@ -0,0 +1,25 @@
+#include <bits/stdc++.h>
+
+#include "gomoryhu.h"
+#include "graphgen.h"
+
+using namespace std;
+
+int main() {
+    // Undirected 30x30 grid with random capacities, seeded so every run builds the same graph.
+    GridGraph grid{30, 30, 1, 100, 1};
+    int V = grid.vertices();
+    GomoryHuTree tree(V);
+    cout << "Number of nodes: " << V << endl;
+    grid.generate([&](int u, int v, int cap) { tree.addEdge(u, v, cap); });
+
+    auto start = chrono::steady_clock::now();
+    tree.build();
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "Gomory-Hu tree: " << tree.flows << " max flows (" << tree.resolved << " re-solved), "
+         << ms << " ms" << endl;
+
+    cout << "Min cut (source, sink): " << tree.minCut(grid.source(), grid.sink()) << endl;
+    cout << "Min cut (0, " << V / 2 << "): " << tree.minCut(0, V / 2) << endl;
+    return 0;
+}
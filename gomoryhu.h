@@ -0,0 +1,162 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <limits>
+#include <cassert>
+#include <algorithm>
+
+#include "flowgraph.h"
+#include "origdinicalgo.h"
+#include "workerpool.h"
+
+using namespace std;
+
+#define NUM_THREADS static_cast<int>(thread::hardware_concurrency())
+
+// ---------------- Gomory-Hu Tree (Gusfield) ----------------
+// All-pairs minimum cuts of an undirected network from n - 1 max-flow computations. Gusfield's
+// algorithm visits s = 1 .. n-1 in order. It cuts s from its current tree parent p[s] and re-hangs
+// every other vertex on s's side of the cut that shared that parent below s. If the parent's own
+// parent is on s's side too, s takes the parent's place in the tree. The result is a Gomory-Hu
+// tree: the minimum u-v cut is the lightest edge on the tree path between u and v.
+//
+// The flows are solved concurrently, each by its own copy of orig::Dinic on one pool worker.
+// Every round, the workers solve the next window of vertices against the parent each has at that
+// moment. The cuts are then committed strictly in order of s. A commit rewrites p[s] and p[t]
+// for its own s and t = p[s], and re-hangs below s every vertex on s's side that hung from t,
+// earlier ones included. But the cut a vertex needs depends only on the pair (s, p[s]) it is
+// taken for, and every cut is computed on the original network. So a cut whose p[s] is still
+// the one it was solved against at commit time is the cut the sequential order would compute.
+// Committing stops at the first vertex whose parent moved. The next round solves that vertex
+// again, together with any later one whose parent moved too; the rest keep their cuts and are
+// committed when their turn comes.
+//
+//   GomoryHuTree tree(V);
+//   tree.addEdge(u, v, cap);   // undirected
+//   tree.build();
+//   tree.minCut(a, b);         // O(tree path length), no further max-flow
+template <class Cap = int, class Index = uint32_t>
+class BasicGomoryHuTree {
+    typedef orig::BasicDinic<Cap, Index> Engine;
+
+public:
+    typedef FlowSum<Cap> Flow;
+    typedef FlowInputEdge<Cap> InputEdge;
+
+    // Max-flow computations of the last build, and how many of them were discarded because an
+    // earlier commit moved the parent they were solved against.
+    long long flows = 0, resolved = 0;
+
+    BasicGomoryHuTree(int V, int num_threads = NUM_THREADS) : V(V), pool(num_threads), proto(V) {}
+
+    // Add an undirected edge of capacity cap between u and v.
+    void addEdge(int u, int v, Cap cap) {
+        proto.addEdge(u, v, cap);
+        proto.addEdge(v, u, cap);
+    }
+
+    void addEdges(const vector<InputEdge> &edges) {
+        for (auto &e : edges)
+            addEdge(e.u, e.v, e.cap);
+    }
+
+    void build() {
+        proto.finalize();
+        flows = resolved = 0;
+        parent.assign(V, 0);
+        weight.assign(V, 0);
+        if (V <= 1) {
+            computeDepths();
+            return;
+        }
+
+        // One residual copy per worker; each solve starts from zero flow on its own copy.
+        vector<Engine> engines(pool.size(), proto);
+        WorkerPool inline_pool(1);
+        int window = pool.size() * 2;
+        vector<int> solved_against(V, -1);
+        vector<Flow> cut_flow(V);
+        vector<vector<uint64_t>> cut_side(window);  // source side of s, at slot s % window
+
+        for (int next = 1; next < V;) {
+            int end = min(V, next + window);
+            vector<int> todo;
+            for (int s = next; s < end; s++) {
+                if (solved_against[s] != parent[s]) {
+                    todo.push_back(s);
+                    resolved += solved_against[s] != -1;
+                }
+            }
+            pool.run((int)todo.size(), [&](int k, int worker_id) {
+                int s = todo[k];
+                Engine &e = engines[worker_id];
+                e.resetFlow();
+                auto r = e.solve(s, parent[s], &inline_pool);
+                solved_against[s] = parent[s];
+                cut_flow[s] = r.flow;
+                cut_side[s % window] = move(r.source_side);
+            });
+            flows += todo.size();
+
+            for (; next < end && solved_against[next] == parent[next]; next++)
+                commit(next, cut_flow[next], cut_side[next % window]);
+        }
+        parent[0] = -1;
+        computeDepths();
+    }
+
+    // Value of the minimum cut between u and v: the lightest edge on their tree path.
+    Flow minCut(int u, int v) const {
+        assert(u != v && !depth.empty());
+        Flow best = numeric_limits<Flow>::max();
+        while (u != v) {
+            if (depth[u] < depth[v])
+                swap(u, v);
+            best = min(best, weight[u]);
+            u = parent[u];
+        }
+        return best;
+    }
+
+    // Tree edge from v to its parent and its weight; vertex 0 is the root, with parent -1.
+    int treeParent(int v) const { return parent[v]; }
+    Flow treeWeight(int v) const { return weight[v]; }
+
+private:
+    int V;
+    WorkerPool pool;
+    Engine proto;  // finalized graph every worker copies
+    vector<int> parent, depth;
+    vector<Flow> weight;
+
+    void commit(int s, Flow f, const vector<uint64_t> &side) {
+        auto onSide = [&](int v) { return side[v >> 6] >> (v & 63) & 1; };
+        int t = parent[s];
+        weight[s] = f;
+        for (int v = 0; v < V; v++)
+            if (v != s && parent[v] == t && onSide(v))
+                parent[v] = s;
+        if (onSide(parent[t])) {
+            parent[s] = parent[t];
+            parent[t] = s;
+            weight[s] = weight[t];
+            weight[t] = f;
+        }
+    }
+
+    void computeDepths() {
+        depth.assign(V, -1);
+        if (V > 0)
+            depth[0] = 0;
+        vector<int> chain;
+        for (int v = 0; v < V; v++) {
+            for (int u = v; depth[u] == -1; u = parent[u])
+                chain.push_back(u);
+            for (; !chain.empty(); chain.pop_back())
+                depth[chain.back()] = depth[parent[chain.back()]] + 1;
+        }
+    }
+};
+
+typedef BasicGomoryHuTree<> GomoryHuTree;
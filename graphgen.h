@@ -0,0 +1,378 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+// ---------------- Seeded Flow Network Generators ----------------
+// Every family is a small parameter struct with vertices(), source(), sink(), name() and
+// generate(addEdge), which streams each arc as addEdge(u, v, cap) in O(E) time and no extra
+// memory, so a generator can feed a solver's addEdge directly (see addEdges below) or fill an
+// edge list. All randomness comes from GenRng, a splitmix64 stream, so the same parameters and
+// seed give the same graph on every platform and standard library, unlike rand() or the
+// <random> distributions.
+
+struct GenRng {
+    uint64_t state;
+
+    explicit GenRng(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform integer in [lo, hi].
+    int range(int lo, int hi) {
+        return lo + (int)(next() % (uint64_t)(hi - lo + 1));
+    }
+
+    // Uniform double in [0, 1).
+    double unit() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+};
+
+// Stream a generated graph into anything with addEdge(u, v, cap).
+template <class Gen, class Solver>
+void addEdges(const Gen &gen, Solver &solver) {
+    gen.generate([&](int u, int v, int cap) { solver.addEdge(u, v, cap); });
+}
+
+// The i -> i+1, i -> i+2 chain the programs in this repo have always used, capacities in [20, 69].
+struct ChainGraph {
+    int n;
+    uint64_t seed = 1;
+
+    int vertices() const { return n; }
+    int source() const { return 0; }
+    int sink() const { return n - 1; }
+    string name() const { return "chain-" + to_string(n); }
+
+    template <class AddEdge>
+    void generate(AddEdge &&addEdge) const {
+        GenRng rng(seed);
+        for (int i = 0; i < n - 1; i++) {
+            addEdge(i, i + 1, rng.range(20, 69));
+            if (i + 2 < n)
+                addEdge(i, i + 2, rng.range(20, 69));
+        }
+    }
+};
+
+// Uniformly random arcs, the sparse random graph of the benchmark.
+struct RandomGraph {
+    int n;
+    long long m;
+    int max_cap = 100;
+    uint64_t seed = 1;
+
+    int vertices() const { return n; }
+    int source() const { return 0; }
+    int sink() const { return n - 1; }
+    string name() const { return "random-" + to_string(n) + "-" + to_string(m); }
+
+    template <class AddEdge>
+    void generate(AddEdge &&addEdge) const {
+        GenRng rng(seed);
+        for (long long i = 0; i < m; i++) {
+            int u = rng.range(0, n - 1);
+            int v = rng.range(0, n - 1);
+            addEdge(u, v, rng.range(1, max_cap));
+        }
+    }
+};
+
+// 'layers' layers of 'width' vertices; every vertex has 'degree' arcs into random vertices of the
+// next layer. s feeds the whole first layer and the last layer drains into t.
+struct LayeredGraph {
+    int layers, width, degree = 3;
+    int max_cap = 100;
+    uint64_t seed = 1;
+
+    int vertices() const { return layers * width + 2; }
+    int source() const { return layers * width; }
+    int sink() const { return layers * width + 1; }
+    string name() const { return "layered-" + to_string(layers) + "x" + to_string(width); }
+
+    template <class AddEdge>
+    void generate(AddEdge &&addEdge) const {
+        GenRng rng(seed);
+        int s = source(), t = sink();
+        for (int i = 0; i < width; i++) {
+            addEdge(s, i, max_cap * degree);
+            addEdge((layers - 1) * width + i, t, max_cap * degree);
+        }
+        for (int l = 0; l + 1 < layers; l++)
+            for (int i = 0; i < width; i++)
+                for (int d = 0; d < degree; d++)
+                    addEdge(l * width + i, (l + 1) * width + rng.range(0, width - 1), rng.range(1, max_cap));
+    }
+};
+
+// x * y * z grid (z = 1 for 2D) with arcs both ways between axis neighbours. s feeds the x = 0
+// face and the x = X - 1 face drains into t, the shape of vision and simulation problems.
+struct GridGraph {
+    int x, y, z = 1;
+    int max_cap = 100;
+    uint64_t seed = 1;
+
+    int cells() const { return x * y * z; }
+    int vertices() const { return cells() + 2; }
+    int source() const { return cells(); }
+    int sink() const { return cells() + 1; }
+    string name() const {
+        return "grid-" + to_string(x) + "x" + to_string(y) + (z > 1 ? "x" + to_string(z) : "");
+    }
+
+    template <class AddEdge>
+    void generate(AddEdge &&addEdge) const {
+        GenRng rng(seed);
+        auto id = [&](int i, int j, int k) { return (k * y + j) * x + i; };
+        for (int k = 0; k < z; k++) {
+            for (int j = 0; j < y; j++) {
+                addEdge(source(), id(0, j, k), max_cap * 6);
+                addEdge(id(x - 1, j, k), sink(), max_cap * 6);
+                for (int i = 0; i < x; i++) {
+                    int u = id(i, j, k);
+                    if (i + 1 < x) {
+                        addEdge(u, id(i + 1, j, k), rng.range(1, max_cap));
+                        addEdge(id(i + 1, j, k), u, rng.range(1, max_cap));
+                    }
+                    if (j + 1 < y) {
+                        addEdge(u, id(i, j + 1, k), rng.range(1, max_cap));
+                        addEdge(id(i, j + 1, k), u, rng.range(1, max_cap));
+                    }
+                    if (k + 1 < z) {
+                        addEdge(u, id(i, j, k + 1), rng.range(1, max_cap));
+                        addEdge(id(i, j, k + 1), u, rng.range(1, max_cap));
+                    }
+                }
+            }
+        }
+    }
+};
+
+// Image segmentation: a width x height pixel grid, 4- or 8-connected, with terminal arcs on every
+// pixel. s -> p and p -> t carry the data terms, here a noisy disc of foreground on background,
+// and arcs both ways between neighbours carry the smoothness term, lower on diagonals.
+struct SegmentationGraph {
+    int width, height, connectivity = 4;
+    int max_cap = 100;
+    uint64_t seed = 1;
+
+    int pixels() const { return width * height; }
+    int vertices() const { return pixels() + 2; }
+    int source() const { return pixels(); }
+    int sink() const { return pixels() + 1; }
+    string name() const {
+        return "segmentation-" + to_string(width) + "x" + to_string(height) + "-" + to_string(connectivity);
+    }
+
+    template <class AddEdge>
+    void generate(AddEdge &&addEdge) const {
+        GenRng rng(seed);
+        double cx = width / 2.0, cy = height / 2.0, r2 = cx * cx / 4 + cy * cy / 4;
+        int smooth = max(1, max_cap / 2), diagonal = max(1, max_cap * 7 / 20);
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) {
+                int p = j * width + i;
+                bool inside = (i - cx) * (i - cx) + (j - cy) * (j - cy) < r2;
+                if (rng.unit() < 0.2)
+                    inside = !inside;
+                int strong = rng.range(max_cap / 2, max_cap), weak = rng.range(0, max_cap / 2);
+                int fg = inside ? strong : weak, bg = inside ? weak : strong;
+                if (fg > 0)
+                    addEdge(source(), p, fg);
+                if (bg > 0)
+                    addEdge(p, sink(), bg);
+                auto link = [&](int q, int cap) {
+                    addEdge(p, q, cap);
+                    addEdge(q, p, cap);
+                };
+                if (i + 1 < width)
+                    link(p + 1, smooth);
+                if (j + 1 < height)
+                    link(p + width, smooth);
+                if (connectivity == 8 && j + 1 < height) {
+                    if (i + 1 < width)
+                        link(p + width + 1, diagonal);
+                    if (i > 0)
+                        link(p + width - 1, diagonal);
+                }
+            }
+        }
+    }
+};
+
+// R-MAT power-law graph on 2^scale vertices (Chakrabarti, Zhan and Faloutsos): each arc picks a
+// quadrant of the adjacency matrix with probabilities a, b, c, 1 - a - b - c, 'scale' times.
+// That is O(scale) per arc. s = 0 and t = 1 are the two heaviest hubs.
+struct RMATGraph {
+    int scale;
+    long long m;
+    double a = 0.57, b = 0.19, c = 0.19;
+    int max_cap = 100;
+    uint64_t seed = 1;
+
+    int vertices() const { return 1 << scale; }
+    int source() const { return 0; }
+    int sink() const { return 1; }
+    string name() const { return "rmat-" + to_string(scale) + "-" + to_string(m); }
+
+    template <class AddEdge>
+    void generate(AddEdge &&addEdge) const {
+        GenRng rng(seed);
+        for (long long i = 0; i < m; i++) {
+            int u = 0, v = 0;
+            for (int bit = scale - 1; bit >= 0; bit--) {
+                double r = rng.unit();
+                if (r < a) {
+                } else if (r < a + b) {
+                    v |= 1 << bit;
+                } else if (r < a + b + c) {
+                    u |= 1 << bit;
+                } else {
+                    u |= 1 << bit;
+                    v |= 1 << bit;
+                }
+            }
+            if (u != v)
+                addEdge(u, v, rng.range(1, max_cap));
+        }
+    }
+};
+
+// s -> left side, m random left -> right arcs, right side -> t: matching-like instances.
+struct BipartiteGraph {
+    int left, right;
+    long long m;
+    int max_cap = 100;
+    uint64_t seed = 1;
+
+    int vertices() const { return left + right + 2; }
+    int source() const { return left + right; }
+    int sink() const { return left + right + 1; }
+    string name() const { return "bipartite-" + to_string(left) + "x" + to_string(right) + "-" + to_string(m); }
+
+    template <class AddEdge>
+    void generate(AddEdge &&addEdge) const {
+        GenRng rng(seed);
+        for (int i = 0; i < left; i++)
+            addEdge(source(), i, rng.range(1, max_cap));
+        for (int j = 0; j < right; j++)
+            addEdge(left + j, sink(), rng.range(1, max_cap));
+        for (long long e = 0; e < m; e++)
+            addEdge(rng.range(0, left - 1), left + rng.range(0, right - 1), rng.range(1, max_cap));
+    }
+};
+
+// AK-style hard instance, deterministic, 2k + 4 vertices. The first piece is a path s -> p1 ->
+// ... -> pk with a unit exit pi -> t from every path vertex: each exit is one shortest path, so
+// Dinic needs k phases that each re-scan the path. The second piece is a path q1 -> ... -> qk,
+// fed at its far end, whose arcs only lead back towards s, the shape that makes push-relabel lift
+// every qi over and over without global relabeling.
+struct AKGraph {
+    int k;
+
+    int vertices() const { return 2 * k + 4; }
+    int source() const { return 2 * k; }
+    int sink() const { return 2 * k + 1; }
+    string name() const { return "ak-" + to_string(k); }
+
+    template <class AddEdge>
+    void generate(AddEdge &&addEdge) const {
+        int s = source(), t = sink();
+        int hub = 2 * k + 2, tail = 2 * k + 3;
+        addEdge(s, 0, k);
+        for (int i = 0; i < k; i++) {
+            if (i + 1 < k)
+                addEdge(i, i + 1, k - i - 1);
+            addEdge(i, t, 1);
+        }
+        addEdge(s, hub, k);
+        addEdge(hub, k + k - 1, k);
+        for (int i = k - 1; i > 0; i--)
+            addEdge(k + i, k + i - 1, k);
+        addEdge(k, tail, k);
+        addEdge(tail, t, k);
+    }
+};
+
+// Genrmf (Goldfarb and Grigoriadis): b frames of a x a grids. In-frame arcs join grid neighbours
+// with capacity c2 * a * a. Each vertex also has one arc into the next frame, following a random
+// permutation, with capacity in [c1, c2]. s is the first vertex of the first frame and t the last
+// vertex of the last frame.
+struct GenrmfGraph {
+    int a, b;
+    int c1 = 1, c2 = 100;
+    uint64_t seed = 1;
+
+    int vertices() const { return a * a * b; }
+    int source() const { return 0; }
+    int sink() const { return a * a * b - 1; }
+    string name() const { return "genrmf-" + to_string(a) + "x" + to_string(b); }
+
+    template <class AddEdge>
+    void generate(AddEdge &&addEdge) const {
+        GenRng rng(seed);
+        int frame = a * a;
+        int in_cap = c2 * a * a;
+        vector<int> perm(frame);
+        for (int f = 0; f < b; f++) {
+            int base = f * frame;
+            for (int r = 0; r < a; r++) {
+                for (int c = 0; c < a; c++) {
+                    int u = base + r * a + c;
+                    if (c + 1 < a) {
+                        addEdge(u, u + 1, in_cap);
+                        addEdge(u + 1, u, in_cap);
+                    }
+                    if (r + 1 < a) {
+                        addEdge(u, u + a, in_cap);
+                        addEdge(u + a, u, in_cap);
+                    }
+                }
+            }
+            if (f + 1 == b)
+                break;
+            for (int i = 0; i < frame; i++)
+                perm[i] = i;
+            for (int i = frame - 1; i > 0; i--)
+                swap(perm[i], perm[rng.range(0, i)]);
+            for (int i = 0; i < frame; i++)
+                addEdge(base + i, base + frame + perm[i], rng.range(c1, c2));
+        }
+    }
+};
+
+// Washington random level graph: 'rows' x 'cols' vertices, each with three arcs into random
+// rows of the next column. s feeds the first column and the last column drains into t.
+struct WashingtonRLG {
+    int rows, cols;
+    int max_cap = 10000;
+    uint64_t seed = 1;
+
+    int vertices() const { return rows * cols + 2; }
+    int source() const { return rows * cols; }
+    int sink() const { return rows * cols + 1; }
+    string name() const { return "washington-rlg-" + to_string(rows) + "x" + to_string(cols); }
+
+    template <class AddEdge>
+    void generate(AddEdge &&addEdge) const {
+        GenRng rng(seed);
+        for (int r = 0; r < rows; r++) {
+            addEdge(source(), r, rng.range(1, max_cap));
+            addEdge((cols - 1) * rows + r, sink(), rng.range(1, max_cap));
+        }
+        for (int c = 0; c + 1 < cols; c++)
+            for (int r = 0; r < rows; r++)
+                for (int d = 0; d < 3; d++)
+                    addEdge(c * rows + r, (c + 1) * rows + rng.range(0, rows - 1), rng.range(1, max_cap));
+    }
+};
@@ -1,217 +1,32 @@
-
-// 'in development'
-
 #include <iostream>
-#include <vector>
-#include <queue>
-#include <deque>
-#include <thread>
-#include <mutex>
-#include <atomic>
 #include <cstdlib>
 #include <ctime>
-#include <algorithm>
-#include <climits>
-#include <functional>
-#include <stack>
-
-using namespace std;
-
-#define INF INT_MAX
-#define NUM_THREADS static_cast<int>(thread::hardware_concurrency())
-
-class Dinic {
-    struct Edge {
-        int v, flow, cap, rev;
-    };
-    int V;
-    vector<vector<Edge>> adj;
-    vector<int> level;
-    // The shared ptr array is used in sequential DFS; in parallel DFS we create thread-local copies.
-    mutex level_mutex;  // Protects level updates in BFS
-    mutex update_mutex; // Protects flow updates in DFS
-
-public:
-    Dinic(int V) : V(V), adj(V), level(V, -1) {}
+#include <cstring>
 
-    // Add an edge from u to v with capacity cap, and a reverse edge with 0 capacity.
-    void addEdge(int u, int v, int cap) {
-        adj[u].push_back({v, 0, cap, (int)adj[v].size()});
-        adj[v].push_back({u, 0, 0, (int)adj[u].size() - 1});
-    }
+#include "improvingalgo.h"
+#include "graphgen.h"
 
-    // ---------------- Parallel BFS Worker ----------------
-    // Processes a chunk of the frontier and writes discovered nodes into its local buffer.
-    void bfs_worker(const vector<int>& frontier, int start, int end,
-                    vector<vector<int>>& local_frontiers, int thread_id) {
-        for (int i = start; i < end; i++) {
-            int u = frontier[i];
-            for (auto &e : adj[u]) {
-                // Protect shared level updates.
-                lock_guard<mutex> lock(level_mutex);
-                if (level[e.v] == -1 && e.flow < e.cap) {
-                    level[e.v] = level[u] + 1;
-                    local_frontiers[thread_id].push_back(e.v);
-                }
-            }
-        }
-    }
-
-    // ---------------- Parallel BFS ----------------
-    bool parallelBFS(int s, int t) {
-        fill(level.begin(), level.end(), -1);
-        vector<int> frontier;
-        frontier.push_back(s);
-        level[s] = 0;
-
-        // Create local buffers (one per thread).
-        vector<vector<int>> local_frontiers(NUM_THREADS);
-        for (int i = 0; i < NUM_THREADS; i++)
-            local_frontiers[i].reserve(V / NUM_THREADS + 10);
-        
-        while (!frontier.empty()) {
-            int f_size = frontier.size();
-            // Use fewer threads if the frontier is small.
-            int num_threads = min(NUM_THREADS, max(1, f_size / 500));
-            for (auto &lf : local_frontiers)
-                lf.clear();
-            
-            vector<thread> threads;
-            int chunk_size = (f_size + num_threads - 1) / num_threads;
-            for (int i = 0; i < num_threads; i++) {
-                int start = i * chunk_size;
-                int end = min((i + 1) * chunk_size, f_size);
-                if (start < end) {
-                    threads.emplace_back(&Dinic::bfs_worker, this,
-                                         cref(frontier), start, end,
-                                         ref(local_frontiers), i);
-                }
-            }
-            for (auto &th : threads)
-                th.join();
-            
-            vector<int> next_frontier;
-            next_frontier.reserve(f_size);
-            for (auto &lf : local_frontiers)
-                next_frontier.insert(next_frontier.end(), lf.begin(), lf.end());
-            
-            frontier.swap(next_frontier);
-        }
-        return level[t] != -1;
-    }
-
-    // ---------------- Experimental Parallel DFS (Iterative) ----------------
-    // Each thread performs an iterative DFS using its own local state (including a pointer array).
-    // When a thread finds an augmenting path, it records the bottleneck flow and (under a lock)
-    // updates the flows along that path.
-    int parallelDFS(int s, int t, int flow) {
-        atomic<int> resultFlow(0);
-        atomic<bool> found(false);
-
-        vector<thread> threads;
-        for (int i = 0; i < NUM_THREADS; i++) {
-            threads.emplace_back([&]() {
-                // Local pointer array to remember the next edge to try for each node.
-                vector<int> local_ptr(V, 0);
-                // Stacks to simulate recursion:
-                // 'path' stores the sequence of nodes in the current DFS path.
-                // 'edge_index' stores the chosen edge index from the parent that led to the current node.
-                // 'path_flow' stores the bottleneck flow along the current path.
-                vector<int> path;
-                vector<int> edge_index;
-                vector<int> path_flow;
-
-                // Initialize DFS with source node.
-                path.push_back(s);
-                edge_index.push_back(-1); // no edge led to s
-                path_flow.push_back(flow);
-
-                while (!path.empty() && !found.load()) {
-                    int u = path.back();
-                    if (u == t) {
-                        // Found an augmenting path.
-                        int pushed = path_flow.back();
-                        {
-                            lock_guard<mutex> lock(update_mutex);
-                            // Walk the path and update flows.
-                            int cur = s;
-                            for (size_t j = 1; j < path.size(); j++) {
-                                int v = path[j];
-                                int idx = edge_index[j];
-                                adj[cur][idx].flow += pushed;
-                                adj[v][adj[cur][idx].rev].flow -= pushed;
-                                cur = v;
-                            }
-                        }
-                        found.store(true);
-                        resultFlow.store(pushed);
-                        break;
-                    }
+using namespace std;
+using improving::Dinic;
 
-                    // Try to advance from u.
-                    if (local_ptr[u] < (int)adj[u].size()) {
-                        auto &e = adj[u][local_ptr[u]];
-                        // Check if edge is eligible.
-                        if (level[e.v] == level[u] + 1 && e.flow < e.cap) {
-                            // Advance along this edge.
-                            int new_flow = min(path_flow.back(), e.cap - e.flow);
-                            path.push_back(e.v);
-                            edge_index.push_back(local_ptr[u]); // record chosen edge
-                            path_flow.push_back(new_flow);
-                            // Increment pointer for node u (so that next time we try a different edge).
-                            local_ptr[u]++;
-                            continue;
-                        } else {
-                            local_ptr[u]++;
-                            continue;
-                        }
-                    } else {
-                        // No more edges from u; backtrack.
-                        path.pop_back();
-                        if (!edge_index.empty()) edge_index.pop_back();
-                        if (!path_flow.empty()) path_flow.pop_back();
-                    }
-                }
-            });
-        }
-    
-        for (auto &th : threads)
-            th.join();
-    
-        return resultFlow.load();
-    }
-    
-    // ---------------- Max Flow Computation ----------------
-    // Uses the parallel BFS and experimental parallel DFS.
-    int maxFlow(int s, int t) {
-        int flow = 0;
-        while (parallelBFS(s, t)) {
-            // Instead of a single shared pointer array, parallelDFS creates its own per-thread copies.
-            while (int pushed = parallelDFS(s, t, INF))
-                flow += pushed;
-        }
-        return flow;
-    }
-};
+int main(int argc, char* argv[]) {
+    // DFS phase: concurrent parallel DFS (default) or the sequential "blocking" flow.
+    Dinic::DFSMode mode = Dinic::PARALLEL_DFS;
+    if (argc > 1 && strcmp(argv[1], "blocking") == 0)
+        mode = Dinic::BLOCKING_FLOW;
 
-int main() {
-    // Seed random number generator.
-    srand(time(0));
-    
     // Example: Build a graph with 10,000 nodes.
     int V = 10000;
     Dinic dinic(V);
     cout << "Number of nodes: " << V << endl;
 
-    // Build a sample graph with random capacities.
-    for (int i = 0; i < V - 1; i++) {
-        dinic.addEdge(i, i + 1, rand() % 50 + 20);
-        if (i + 2 < V)
-            dinic.addEdge(i, i + 2, rand() % 50 + 20);
-    }
+    // i -> i+1, i -> i+2 chain, seeded so every run builds the same graph.
+    addEdges(ChainGraph{V, 1}, dinic);
+    dinic.finalize();
+    dinic.dfs_mode = mode;
 
-    cout << "Using " << NUM_THREADS << " threads for parallel BFS and experimental parallel DFS." << endl;
-    int max_flow = dinic.maxFlow(0, V - 1);
+    cout << "Using " << NUM_THREADS << " threads for parallel BFS and parallel DFS." << endl;
+    long long max_flow = dinic.maxFlow(0, V - 1);
     cout << "Max Flow (Parallel BFS from Paper with Parallel and iterative DFS): " << max_flow << endl;
 
     return 0;
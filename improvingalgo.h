@@ -0,0 +1,567 @@
+#pragma once
+
+// 'in development'
+
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <stack>
+#include <cstring>
+#include <chrono>
+
+#include "flowgraph.h"
+#include "flowresult.h"
+#include "flowstats.h"
+#include "workerpool.h"
+
+using namespace std;
+
+#define NUM_THREADS static_cast<int>(thread::hardware_concurrency())
+
+namespace improving {
+
+// Capacity type Cap and arc index type Index as in BasicFlowGraph.
+//
+// Given a NUMA topology (usually &NumaTopology::machine()), the pool is pinned across the nodes
+// and every node owns a contiguous range of vertices with their arcs, levels and current-arc
+// pointers, all placed in its memory by first touch (see numa.h). The BFS then runs node by node
+// (see numaBFS). The DFS stays as it is: augmenting paths cross partitions freely.
+// Arcs are placed at every build and rebuild of the graph, levels and pointers again by maxFlow
+// after each (see placeVertexArrays). The pool pins the thread that constructs the solver to
+// node 0's CPUs until the solver is destroyed, which must happen on that same thread so it gets
+// its own CPU mask back (see WorkerPool).
+template <class Cap = int, class Index = uint32_t>
+class BasicDinic {
+    typedef BasicFlowGraph<Cap, Index> Graph;
+    typedef typename Graph::Edge Edge;
+    typedef typename Graph::Flow Flow;
+    int V;
+    Graph g;
+    WorkerPool pool;  // Persistent BFS workers, reused across levels and phases
+    GraphArray<int> level;
+    // Current-arc pointers, shared by blockingFlow and all parallelDFS workers.
+    GraphArray<Index> ptr;
+    vector<Index> path;  // Arc stack of blockingFlow
+    long long paths_found = 0;  // Augmenting paths of the current phase, for stats
+    vector<char> dead;  // Dead-end vertices of the current parallelDFS phase
+    atomic<bool> rolled_back{false};  // Some parallelDFS reservation was undone this phase
+    // parallelBFS scratch, sized on first use: the current and next frontier and each worker's
+    // share of the next one.
+    vector<int> frontier, next_frontier;
+    vector<WorkerBuffer> local_frontiers;
+
+    // NUMA mode: vertex ranges per node and the graph build they were taken from, the per-node
+    // frontiers of numaBFS, each worker's next frontier and its batches of vertices for other
+    // nodes (worker * nodes + node), and per-node claim counters.
+    struct alignas(64) NodeCursor {
+        atomic<size_t> next{0};
+    };
+    NumaPartition parts;
+    size_t parts_build = 0;
+    vector<WorkerBuffer> node_frontier, numa_next, batches;
+    vector<NodeCursor> cursors;
+
+public:
+    enum DFSMode { BLOCKING_FLOW, PARALLEL_DFS };
+    DFSMode dfs_mode = BLOCKING_FLOW;
+
+    // Phases and time spent building level graphs and pushing blocking flows in the last maxFlow.
+    int phases = 0;
+    double bfs_ms = 0, dfs_ms = 0;
+    // Per-phase counters and timings of the last maxFlow; filled in only when built with
+    // FLOW_STATS (see flowstats.h).
+    FlowStats stats;
+
+    BasicDinic(int V, int num_threads = NUM_THREADS, const NumaTopology *numa = nullptr)
+        : V(V), g(V), pool(num_threads, numa), dead(V, 0) {
+        level.resize(V);
+        fill(level.begin(), level.end(), -1);
+        ptr.resize(V);
+    }
+
+    // Add an edge from u to v with capacity cap, and a reverse edge with 0 capacity. Returns the
+    // edge's id for setCapacity and removeEdge.
+    size_t addEdge(int u, int v, Cap cap) {
+        return g.addEdge(u, v, cap);
+    }
+
+    // Bulk form of addEdge for loaders; takes over the list.
+    void addEdges(vector<typename Graph::InputEdge> &&edges) {
+        g.addEdges(move(edges));
+    }
+
+    // Freeze the added edges into the CSR arc array, on the solver's pool when there are many.
+    // maxFlow calls it if the caller didn't.
+    void finalize() {
+        g.finalize(&pool);
+    }
+
+    // Save the finalized graph as a binary snapshot, or open one instead of adding edges
+    // (see FlowGraph). The snapshot must have this solver's vertex count.
+    void saveSnapshot(const string &path) {
+        finalize();
+        g.saveSnapshot(path);
+    }
+
+    void openSnapshot(const string &path) {
+        g.openSnapshot(path);
+    }
+
+    // ---------------- Incremental Updates ----------------
+    // maxFlow keeps its flow in the graph and the next call with the same s and t continues
+    // from it, so edges can be changed between calls without starting over. Edges added after
+    // a solve are merged in by the next one; a lowered or removed edge has its flow repaired
+    // locally first (see FlowGraph).
+    void setCapacity(size_t edge, Cap cap) {
+        g.setCapacity(edge, cap);
+    }
+
+    void removeEdge(size_t edge) {
+        g.removeEdge(edge);
+    }
+
+    Flow edgeFlow(size_t edge) const {
+        return g.edgeFlow(edge);
+    }
+
+    // Drop the kept flow so the next maxFlow starts from zero.
+    void resetFlow() {
+        g.resetFlow();
+    }
+
+    // ---------------- Parallel BFS Worker (Lock-Free) ----------------
+    // Processes a chunk of the frontier and writes discovered nodes into its local buffer.
+    // A node is claimed by a compare-and-swap of its level from -1, so exactly one thread
+    // labels it and adds it to the next frontier; there is no other per-edge synchronization.
+    void bfs_worker(const vector<int>& frontier, int start, int end,
+                    vector<WorkerBuffer>& local_frontiers, int thread_id) {
+        vector<int> &out = local_frontiers[thread_id].items;
+        for (int i = start; i < end; i++) {
+            int u = frontier[i];
+            int next_level = level[u] + 1;
+            for (Index j = g.off[u]; j < g.off[u + 1]; j++) {
+                Edge &e = g.arcs[j];
+                if (e.res > 0 && __atomic_load_n(&level[e.v], __ATOMIC_RELAXED) == -1) {
+                    int expected = -1;
+                    if (__atomic_compare_exchange_n(&level[e.v], &expected, next_level, false,
+                                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                        out.push_back(e.v);
+                }
+            }
+        }
+    }
+
+    // ---------------- Parallel BFS ----------------
+    bool parallelBFS(int s, int t) {
+        fill(level.begin(), level.end(), -1);
+        if (local_frontiers.empty()) {
+            local_frontiers.resize(pool.size());
+            for (auto &lf : local_frontiers)
+                lf.items.reserve(V / pool.size() + 10);
+        }
+        frontier.assign(1, s);
+        level[s] = 0;
+
+        while (!frontier.empty()) {
+            int f_size = frontier.size();
+            for (auto &lf : local_frontiers)
+                lf.items.clear();
+
+            // Hand the frontier to the pool in chunks; use fewer chunks if the frontier is small,
+            // in which case the calling thread expands it alone without waking the workers.
+            int num_chunks = min(pool.size(), max(1, f_size / 500));
+            int chunk_size = (f_size + num_chunks - 1) / num_chunks;
+            pool.run(num_chunks, [&](int i, int worker_id) {
+                int start = i * chunk_size;
+                int end = min((i + 1) * chunk_size, f_size);
+                if (start < end)
+                    bfs_worker(frontier, start, end, local_frontiers, worker_id);
+            });
+            
+            next_frontier.clear();
+            for (auto &lf : local_frontiers)
+                next_frontier.insert(next_frontier.end(), lf.items.begin(), lf.items.end());
+
+            frontier.swap(next_frontier);
+        }
+        return level[t] != -1;
+    }
+
+    // ---------------- NUMA BFS ----------------
+    // parallelBFS for a pool pinned across NUMA nodes. The frontier is kept per node and holds
+    // only vertices the node owns, and the node's workers expand it, so the arcs they scan and the
+    // levels they set are in local memory. A head owned by another node is not labelled on the
+    // spot: it goes into the worker's batch for that node. Once the level is expanded, each node's
+    // workers drain the batches addressed to it and label the new vertices there. Cross-node
+    // traffic is thus one batch per worker and node per level instead of a remote
+    // compare-and-swap per arc, and every level entry is written only by its owner.
+    static const size_t NUMA_CHUNK = 256;  // frontier vertices a worker claims at a time
+
+    bool numaBFS(int s, int t) {
+        int nodes = pool.nodes();
+        pool.runEach([&](int w, int) {
+            int n = pool.node(w);
+            auto range = pool.nodeShare(w, parts.first[n], parts.first[n + 1]);
+            fill(level.begin() + range.first, level.begin() + range.second, -1);
+        });
+        for (auto &f : node_frontier)
+            f.items.clear();
+        node_frontier[parts.owner(s)].items.push_back(s);
+        level[s] = 0;
+
+        for (int next_level = 1;; next_level++) {
+            size_t f_size = 0;
+            for (auto &f : node_frontier)
+                f_size += f.items.size();
+            if (f_size == 0)
+                break;
+            for (auto &c : cursors)
+                c.next.store(0, memory_order_relaxed);
+
+            // Expand each node's frontier on its own workers.
+            pool.runEach([&](int w, int) {
+                int n = pool.node(w);
+                const vector<int> &front = node_frontier[n].items;
+                vector<int> &out = numa_next[w].items;
+                out.clear();
+                for (int m = 0; m < nodes; m++)
+                    batches[w * nodes + m].items.clear();
+                size_t begin;
+                while ((begin = cursors[n].next.fetch_add(NUMA_CHUNK, memory_order_relaxed)) <
+                       front.size()) {
+                    size_t end = min(front.size(), begin + NUMA_CHUNK);
+                    for (size_t k = begin; k < end; k++) {
+                        int u = front[k];
+                        for (Index j = g.off[u]; j < g.off[u + 1]; j++) {
+                            const Edge &e = g.arcs[j];
+                            if (e.res <= 0)
+                                continue;
+                            int owner = parts.owner(e.v);
+                            if (owner != n) {
+                                batches[w * nodes + owner].items.push_back(e.v);
+                            } else if (__atomic_load_n(&level[e.v], __ATOMIC_RELAXED) == -1) {
+                                int expected = -1;
+                                if (__atomic_compare_exchange_n(&level[e.v], &expected, next_level,
+                                                                false, __ATOMIC_RELAXED,
+                                                                __ATOMIC_RELAXED))
+                                    out.push_back(e.v);
+                            }
+                        }
+                    }
+                }
+            });
+
+            // Drain the batches: node n's workers claim whole batches addressed to n.
+            for (auto &c : cursors)
+                c.next.store(0, memory_order_relaxed);
+            pool.runEach([&](int w, int) {
+                int n = pool.node(w);
+                vector<int> &out = numa_next[w].items;
+                size_t from;
+                while ((from = cursors[n].next.fetch_add(1, memory_order_relaxed)) <
+                       (size_t)pool.size()) {
+                    for (int v : batches[from * nodes + n].items) {
+                        if (__atomic_load_n(&level[v], __ATOMIC_RELAXED) != -1)
+                            continue;
+                        int expected = -1;
+                        if (__atomic_compare_exchange_n(&level[v], &expected, next_level, false,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                            out.push_back(v);
+                    }
+                }
+            });
+
+            for (int n = 0; n < nodes; n++)
+                node_frontier[n].items.clear();
+            for (int w = 0; w < pool.size(); w++) {
+                vector<int> &f = node_frontier[pool.node(w)].items;
+                f.insert(f.end(), numa_next[w].items.begin(), numa_next[w].items.end());
+            }
+        }
+        return level[t] != -1;
+    }
+
+    // On a NUMA pool, split the vertices by arcs the way the graph build did and give each node
+    // the level and current-arc entries of its vertices, first touched by the node's workers.
+    // maxFlow redoes it whenever the graph has been rebuilt since, as merged edges move the
+    // offsets.
+    void placeVertexArrays() {
+        int nodes = pool.nodes();
+        parts = NumaPartition::byArcs(g.off.data(), V, nodes);
+        parts_build = g.builds();
+        level.allocateUntouched(V);
+        ptr.allocateUntouched(V);
+        pool.runEach([&](int w, int) {
+            int n = pool.node(w);
+            auto range = pool.nodeShare(w, parts.first[n], parts.first[n + 1]);
+            fill(level.begin() + range.first, level.begin() + range.second, -1);
+            fill(ptr.begin() + range.first, ptr.begin() + range.second, 0);
+        });
+        node_frontier.assign(nodes, WorkerBuffer());
+        numa_next.assign(pool.size(), WorkerBuffer());
+        batches.assign(pool.size() * nodes, WorkerBuffer());
+        cursors = vector<NodeCursor>(nodes);
+    }
+
+    // ---------------- Parallel DFS (Concurrent Blocking Flow) ----------------
+    // All pool workers search the level graph at once. Each claims the next unused arc out of s and
+    // keeps augmenting through it until it is saturated or leads to a dead end. Capacity is reserved
+    // with a compare-and-swap on each arc's residual, first to last; if an arc no longer has the
+    // bottleneck available, the reservations already made on the path are rolled back and the search
+    // retreats to that arc. Current-arc pointers and dead-end marks are shared, so a vertex proven
+    // useless by one worker is skipped by all of them. In a phase, level graph arcs only lose residual
+    // capacity, so both only ever move forward.
+
+    // Move a shared current-arc pointer forward to i unless another worker already passed it.
+    static void advancePtr(Index &p, Index i) {
+        Index cur = atomicLoad(p);
+        while (cur < i && !__atomic_compare_exchange_n(&p, &cur, i, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            ;
+    }
+
+    // Reserve 'pushed' units on the arc: fails if it has less than that left.
+    static bool reserve(Edge &e, Cap pushed) {
+        Cap r = atomicLoad(e.res);
+        while (r >= pushed) {
+            Cap next = r - pushed;
+            if (__atomic_compare_exchange(&e.res, &r, &next, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                return true;
+        }
+        return false;
+    }
+
+    void dfs_worker(int s, int t, atomic<Index>& next_source_arc, Flow& phase_flow) {
+        vector<Index> path;  // arcs from s to u
+        Flow flow = 0;
+        long long paths = 0;
+        while (true) {
+            Index a = next_source_arc.fetch_add(1);
+            if (a >= g.off[s + 1])
+                break;
+            path.assign(1, a);
+            int u = g.arcs[a].v;
+            if (level[u] != 1 || atomicLoad(g.arcs[a].res) == 0)
+                continue;
+
+            while (!path.empty()) {
+                if (u == t) {
+                    Cap pushed = numeric_limits<Cap>::max();
+                    for (Index p : path)
+                        pushed = min(pushed, atomicLoad(g.arcs[p].res));
+
+                    // Reserve along the path; 'stop' is where the search resumes from.
+                    int stop = (int)path.size();
+                    if (pushed > 0) {
+                        for (int i = 0; i < (int)path.size(); i++) {
+                            if (!reserve(g.arcs[path[i]], pushed)) {
+                                for (int j = 0; j < i; j++)
+                                    atomicAdd(g.arcs[path[j]].res, pushed);
+                                rolled_back.store(true, memory_order_relaxed);
+                                stop = i;
+                                break;
+                            }
+                        }
+                    }
+                    if (pushed > 0 && stop == (int)path.size()) {
+                        for (Index p : path)
+                            atomicAdd(g.arcs[g.arcs[p].rev].res, pushed);
+                        flow += pushed;
+                        paths++;
+                    }
+                    // Retreat to the tail of the first arc without residual capacity left. If every
+                    // arc still has some (a concurrent rollback freed it), stay at t and go again.
+                    for (int i = 0; i < stop; i++) {
+                        if (atomicLoad(g.arcs[path[i]].res) == 0) {
+                            stop = i;
+                            break;
+                        }
+                    }
+                    if (stop < (int)path.size()) {
+                        u = g.arcs[g.arcs[path[stop]].rev].v;
+                        path.resize(stop);
+                    }
+                    continue;
+                }
+
+                Index i = atomicLoad(ptr[u]);
+                for (; i < g.off[u + 1]; i++) {
+                    Edge &e = g.arcs[i];
+                    if (level[e.v] == level[u] + 1 && atomicLoad(e.res) > 0 &&
+                        !__atomic_load_n(&dead[e.v], __ATOMIC_RELAXED))
+                        break;
+                }
+                advancePtr(ptr[u], i);
+
+                if (i < g.off[u + 1]) {
+                    path.push_back(i);
+                    u = g.arcs[i].v;
+                } else {
+                    // Dead end: retire u for the rest of the phase and retreat.
+                    __atomic_store_n(&dead[u], 1, __ATOMIC_RELAXED);
+                    Index p = path.back();
+                    path.pop_back();
+                    u = g.arcs[g.arcs[p].rev].v;
+                }
+            }
+        }
+        atomicAdd(phase_flow, flow);
+        if constexpr (FlowStats::ENABLED)
+            atomicAdd(paths_found, paths);
+    }
+
+    // Runs the workers on the pool and returns the flow pushed in this phase. A rolled-back
+    // reservation can make another worker skip an arc that ends up with residual capacity after
+    // all, so in that case a sequential blockingFlow pass over the same level graph finishes the job.
+    Flow parallelDFS(int s, int t) {
+        copy(g.off.begin(), g.off.end() - 1, ptr.begin());
+        fill(dead.begin(), dead.end(), 0);
+        rolled_back.store(false);
+        atomic<Index> next_source_arc(g.off[s]);
+        Flow phase_flow = 0;
+        pool.run(pool.size(), [&](int, int) {
+            dfs_worker(s, t, next_source_arc, phase_flow);
+        });
+
+        Flow flow = phase_flow;
+        if (rolled_back.load()) {
+            copy(g.off.begin(), g.off.end() - 1, ptr.begin());
+            flow += blockingFlow(s, t);
+        }
+        return flow;
+    }
+
+    // ---------------- Blocking Flow (Iterative) ----------------
+    // Finds a blocking flow in the level graph without recursion. 'path' holds the arcs from s to
+    // the current vertex and ptr[] the current arc of every vertex. On reaching t the path is
+    // augmented by its bottleneck and the search retreats only to the tail of the first arc it
+    // saturated, so the flow still available on the rest of the path goes down the next branch
+    // instead of re-walking from s. A vertex whose arcs are exhausted is a dead end: the search
+    // retreats and its parent skips the arc leading to it for the rest of the phase.
+    Flow blockingFlow(int s, int t) {
+        Flow total = 0;
+        path.clear();
+        int u = s;
+        while (true) {
+            if (u == t) {
+                Cap pushed = numeric_limits<Cap>::max();
+                for (Index a : path)
+                    pushed = min(pushed, g.arcs[a].res);
+                int saturated = -1;
+                for (int i = 0; i < (int)path.size(); i++) {
+                    Edge &e = g.arcs[path[i]];
+                    e.res -= pushed;
+                    g.arcs[e.rev].res += pushed;
+                    if (saturated == -1 && e.res == 0)
+                        saturated = i;
+                }
+                total += pushed;
+                if constexpr (FlowStats::ENABLED)
+                    paths_found++;
+                u = g.arcs[g.arcs[path[saturated]].rev].v;
+                path.resize(saturated);
+                continue;
+            }
+
+            Index &i = ptr[u];
+            while (i < g.off[u + 1] &&
+                   !(level[g.arcs[i].v] == level[u] + 1 && g.arcs[i].res > 0))
+                i++;
+
+            if (i < g.off[u + 1]) {
+                path.push_back(i);
+                u = g.arcs[i].v;
+            } else {
+                if (u == s)
+                    break;
+                Index a = path.back();
+                path.pop_back();
+                u = g.arcs[g.arcs[a].rev].v;
+                ptr[u]++;
+            }
+        }
+        return total;
+    }
+
+    // ---------------- Max Flow Computation ----------------
+    // Uses the parallel BFS (per node on a NUMA pool), then the iterative blocking flow or the
+    // concurrent parallel DFS.
+    Flow maxFlow(int s, int t) {
+        finalize();
+        bool numa = pool.nodes() > 1;
+        if (numa && parts_build != g.builds())
+            placeVertexArrays();
+        g.repairFlow(s, t);
+        phases = 0;
+        bfs_ms = dfs_ms = 0;
+        if constexpr (FlowStats::ENABLED)
+            stats.clear();
+        Flow flow = g.outflow(s);
+        auto start = chrono::steady_clock::now(), t0 = start;
+        while (numa ? numaBFS(s, t) : parallelBFS(s, t)) {
+            auto t1 = chrono::steady_clock::now();
+            Flow pushed;
+            if (dfs_mode == BLOCKING_FLOW) {
+                copy(g.off.begin(), g.off.end() - 1, ptr.begin());
+                pushed = blockingFlow(s, t);
+            } else {
+                pushed = parallelDFS(s, t);
+            }
+            flow += pushed;
+            auto t2 = chrono::steady_clock::now();
+            double phase_bfs = chrono::duration<double, milli>(t1 - t0).count();
+            double phase_dfs = chrono::duration<double, milli>(t2 - t1).count();
+            bfs_ms += phase_bfs;
+            dfs_ms += phase_dfs;
+            phases++;
+            t0 = t2;
+            if constexpr (FlowStats::ENABLED) {
+                recordPhase(t, phase_bfs, phase_dfs, labelledArcs(g, level), pushed);
+                t0 = chrono::steady_clock::now();  // keep the bookkeeping out of the next BFS
+            }
+        }
+        double last_bfs = msSince(t0);
+        bfs_ms += last_bfs;
+        if constexpr (FlowStats::ENABLED) {
+            stats.final_bfs_ms = last_bfs;
+            stats.final_bfs_arcs = labelledArcs(g, level);
+            stats.total_ms = msSince(start);
+        }
+        return flow;
+    }
+
+    void recordPhase(int t, double bfs, double dfs, long long bfs_arcs, Flow pushed) {
+        PhaseStats p;
+        p.bfs_ms = bfs;
+        p.dfs_ms = dfs;
+        p.bfs_arcs = bfs_arcs;
+        p.dfs_arcs = retiredArcs(g, ptr);
+        p.paths = paths_found;
+        p.flow = (double)pushed;
+        p.sink_level = level[t];
+        stats.phases.push_back(p);
+        paths_found = 0;
+    }
+
+    // ---------------- Results ----------------
+    typedef BasicFlowResult<Cap, Index> Result;
+
+    // maxFlow plus the minimum cut and a view of the arc flows (see flowresult.h). The last BFS
+    // of maxFlow failed to reach t, so its levels already mark the source side.
+    Result solve(int s, int t) {
+        Flow flow = maxFlow(s, t);
+        return makeFlowResult(g, flow, [&](int v) { return level[v] != -1; }, &pool);
+    }
+};
+
+typedef BasicDinic<> Dinic;
+
+} // namespace improving
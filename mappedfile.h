@@ -0,0 +1,106 @@
+#pragma once
+
+#include <string>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Mapping of a whole file. By default it is read-only. With copy_on_write the pages are also
+// writable, but writes stay private to this process and never reach the file, which is how a
+// solver updates the flows of a mapped graph snapshot.
+class MappedFile {
+public:
+    explicit MappedFile(const string &path, bool copy_on_write = false) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           copy_on_write ? FILE_ATTRIBUTE_NORMAL : FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw runtime_error(path + ": cannot open");
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            release();
+            throw runtime_error(path + ": cannot stat");
+        }
+        len = (size_t)size.QuadPart;
+        if (len == 0)
+            return;
+        mapping = CreateFileMappingA(file, nullptr, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY,
+                                     0, 0, nullptr);
+        if (mapping)
+            ptr = (char*)MapViewOfFile(mapping, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+        if (!ptr) {
+            release();
+            throw runtime_error(path + ": cannot map");
+        }
+#else
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw runtime_error(path + ": cannot open");
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            release();
+            throw runtime_error(path + ": cannot stat");
+        }
+        len = (size_t)st.st_size;
+        if (len == 0)
+            return;
+        void *p = mmap(nullptr, len, copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ,
+                       MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            release();
+            throw runtime_error(path + ": cannot map");
+        }
+        if (!copy_on_write)
+            madvise(p, len, MADV_SEQUENTIAL);
+        ptr = (char*)p;
+#endif
+    }
+
+    ~MappedFile() {
+        release();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Writable only for copy-on-write mappings.
+    char* data() const { return ptr; }
+    size_t size() const { return len; }
+
+private:
+    char *ptr = nullptr;
+    size_t len = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    // Unmap and close whatever is open. The constructor calls it before throwing, since the
+    // destructor does not run for an object whose constructor threw.
+    void release() {
+#ifdef _WIN32
+        if (ptr)
+            UnmapViewOfFile(ptr);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+#else
+        if (ptr)
+            munmap(ptr, len);
+        if (fd >= 0)
+            close(fd);
+#endif
+    }
+};
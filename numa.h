@@ -0,0 +1,191 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <new>
+#include <cstdio>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+// ---------------- NUMA Topology ----------------
+// CPUs of every NUMA node that has any, read once from /sys/devices/system/node. Elsewhere, or
+// when that directory is missing, the machine is one node holding all hardware threads.
+//
+// Nothing here needs libnuma. Memory placement relies on the kernel's default first-touch policy:
+// a page of fresh anonymous memory lands on the node of the thread that first writes it. A
+// pinned worker pool (see WorkerPool) that fills each node's part of an UntouchedRegion thereby
+// puts it on that node.
+struct NumaTopology {
+    vector<vector<int>> node_cpus;
+
+    int nodes() const { return (int)node_cpus.size(); }
+
+    static const NumaTopology &machine() {
+        static const NumaTopology topology = detect();
+        return topology;
+    }
+
+    // Parse a kernel CPU or node list such as "0-3,8-11".
+    static vector<int> parseList(const string &list) {
+        vector<int> ids;
+        stringstream in(list);
+        string item;
+        while (getline(in, item, ',')) {
+            int lo, hi;
+            if (sscanf(item.c_str(), "%d-%d", &lo, &hi) == 2) {
+                for (int i = lo; i <= hi; i++)
+                    ids.push_back(i);
+            } else if (sscanf(item.c_str(), "%d", &lo) == 1) {
+                ids.push_back(lo);
+            }
+        }
+        return ids;
+    }
+
+private:
+    static NumaTopology detect() {
+        NumaTopology t;
+#ifdef __linux__
+        const string root = "/sys/devices/system/node/";
+        string line;
+        ifstream online(root + "online");
+        if (getline(online, line)) {
+            for (int node : parseList(line)) {
+                ifstream cpulist(root + "node" + to_string(node) + "/cpulist");
+                string cpus;
+                if (getline(cpulist, cpus) && !parseList(cpus).empty())
+                    t.node_cpus.push_back(parseList(cpus));
+            }
+        }
+#endif
+        if (t.node_cpus.empty()) {
+            t.node_cpus.emplace_back();
+            for (int c = 0; c < max(1, (int)thread::hardware_concurrency()); c++)
+                t.node_cpus[0].push_back(c);
+        }
+        return t;
+    }
+};
+
+// Restrict the calling thread to 'cpus'. Returns false where that is not supported or the call
+// fails, in which case the thread keeps running wherever the scheduler puts it.
+inline bool pinThread(const vector<int> &cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus)
+        if (c >= 0 && c < CPU_SETSIZE)
+            CPU_SET(c, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+// The calling thread's CPU mask at construction, for putting it back after pinThread.
+class SavedAffinity {
+public:
+    SavedAffinity() {
+#ifdef __linux__
+        CPU_ZERO(&set);
+        saved = pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+    }
+
+    // Give the calling thread the saved mask again. Returns false if there is none.
+    bool restore() const {
+#ifdef __linux__
+        return saved && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+private:
+#ifdef __linux__
+    cpu_set_t set;
+#endif
+    bool saved = false;
+};
+
+// Zeroed memory that no thread has touched yet, so the pages of each part go to whichever node
+// writes them first.
+class UntouchedRegion {
+public:
+    explicit UntouchedRegion(size_t bytes) : len(bytes) {
+        if (len == 0)
+            return;
+#ifdef _WIN32
+        ptr = (char*)VirtualAlloc(nullptr, len, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (!ptr)
+            throw bad_alloc();
+#else
+        void *p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            throw bad_alloc();
+        ptr = (char*)p;
+#endif
+    }
+
+    ~UntouchedRegion() {
+        if (!ptr)
+            return;
+#ifdef _WIN32
+        VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+        munmap(ptr, len);
+#endif
+    }
+
+    UntouchedRegion(const UntouchedRegion&) = delete;
+    UntouchedRegion& operator=(const UntouchedRegion&) = delete;
+
+    char* data() const { return ptr; }
+    size_t size() const { return len; }
+
+private:
+    char *ptr = nullptr;
+    size_t len;
+};
+
+// ---------------- Vertex Partition ----------------
+// Contiguous vertex ranges, one per node, splitting the arcs evenly: node n owns vertices
+// [first[n], first[n + 1]) together with their arcs and per-vertex solver state. The graph
+// builder and the solvers derive it from the same offsets, so they agree on every owner.
+struct NumaPartition {
+    vector<int> first;
+
+    int nodes() const { return (int)first.size() - 1; }
+
+    int owner(int v) const {
+        int n = 0;
+        while (v >= first[n + 1])
+            n++;
+        return n;
+    }
+
+    template <class Index>
+    static NumaPartition byArcs(const Index *off, int V, int nodes) {
+        NumaPartition p;
+        p.first.resize(nodes + 1);
+        for (int n = 0; n < nodes; n++) {
+            Index target = (Index)((double)off[V] * n / nodes);
+            p.first[n] = (int)(lower_bound(off, off + V, target) - off);
+        }
+        p.first[nodes] = V;
+        return p;
+    }
+};
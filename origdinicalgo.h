@@ -0,0 +1,331 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "flowgraph.h"
+#include "flowresult.h"
+#include "flowstats.h"
+using namespace std;
+
+namespace orig {
+
+// Dinic's Algorithm, on capacity type Cap and arc index type Index (see BasicFlowGraph).
+template <class Cap = int, class Index = uint32_t>
+class BasicDinic {
+    typedef BasicFlowGraph<Cap, Index> Graph;
+    typedef typename Graph::Edge Edge;
+    typedef typename Graph::Flow Flow;
+    int V;
+    Graph g;
+    vector<int> level;
+    vector<Index> ptr;
+    vector<Index> path;  // Arc stack of blockingFlow
+    vector<int> bfs_queue, sink_queue;  // vertices bfs labelled, in order; pruneToSink's queue
+    vector<char> on_path;  // pruneToSink's marks, all 0 between calls
+    Cap delta = UNIT;    // Arcs with less residual than this are not eligible in bfs and dfs
+    long long paths_found = 0;  // Augmenting paths of the current phase, for stats
+    long long bfs_scanned = 0;  // Arcs the last bfs scanned, for stats
+
+    // Smallest positive residual: 1, or the least positive value of a floating-point Cap.
+    static constexpr Cap UNIT = is_integral<Cap>::value ? Cap(1) : numeric_limits<Cap>::denorm_min();
+
+public:
+    // Capacity scaling: maxFlow runs its phases with a threshold delta, starting at firstDelta
+    // and halving down to 1. Only arcs with at least delta residual count in bfs and dfs, so
+    // early phases push large amounts along few paths and skip the small augmentations plain
+    // Dinic makes and later cancels. Every threshold takes its own phases, each with a BFS, so
+    // it pays off only where few thresholds carry most of the flow; it is off by default, and
+    // the benchmark's orig-dinic-scaling entry shows where it helps.
+    bool scaling = false;
+
+    // After bfs reaches t, a second BFS backwards from t keeps the level only of vertices that
+    // lie on a shortest s-t path, so the blocking flow never steps off one. It costs a scan of
+    // the level graph's arcs into those vertices and pays off when most of the labelled
+    // vertices are side branches; off by default, compare with orig-dinic-sink-bfs.
+    bool sink_bfs = false;
+
+    BasicDinic(int V) : V(V), g(V), level(V), ptr(V), on_path(V) {}
+
+    // Returns the new edge's id, for setCapacity and removeEdge.
+    size_t addEdge(int u, int v, Cap cap) {
+        return g.addEdge(u, v, cap);
+    }
+
+    // Bulk form of addEdge for loaders; takes over the list.
+    void addEdges(vector<typename Graph::InputEdge> &&edges) {
+        g.addEdges(move(edges));
+    }
+
+    // Freeze the added edges into the CSR arc array. maxFlow calls it if the caller didn't.
+    void finalize() {
+        g.finalize();
+    }
+
+    // Start over on a finalized graph of n vertices and 'edges', reusing this solver's
+    // allocations (see FlowGraph::assign).
+    void assign(int n, const vector<typename Graph::InputEdge> &edges) {
+        V = n;
+        g.assign(n, edges);
+        level.resize(n);
+        ptr.resize(n);
+        on_path.assign(n, 0);
+    }
+
+    // Save the finalized graph as a binary snapshot, or open one instead of adding edges
+    // (see FlowGraph). The snapshot must have this solver's vertex count.
+    void saveSnapshot(const string &path) {
+        finalize();
+        g.saveSnapshot(path);
+    }
+
+    void openSnapshot(const string &path) {
+        g.openSnapshot(path);
+    }
+
+    // ---------------- Incremental Updates ----------------
+    // maxFlow keeps its flow in the graph and the next call with the same s and t continues
+    // from it, so edges can be changed between calls without starting over. Edges added after
+    // a solve are merged in by the next one; a lowered or removed edge has its flow repaired
+    // locally first (see FlowGraph).
+    void setCapacity(size_t edge, Cap cap) {
+        g.setCapacity(edge, cap);
+    }
+
+    void removeEdge(size_t edge) {
+        g.removeEdge(edge);
+    }
+
+    Flow edgeFlow(size_t edge) const {
+        return g.edgeFlow(edge);
+    }
+
+    // Drop the kept flow so the next maxFlow starts from zero.
+    void resetFlow() {
+        g.resetFlow();
+    }
+
+    // Level graph by BFS from s. It stops as soon as t is labelled: every vertex of a lower level
+    // is labelled by then, and nothing at t's level or beyond lies on a shortest path to t. When
+    // t is not reached the search runs to the end, so level[] then marks exactly the vertices
+    // reachable from s, which is where solve() reads the cut from.
+    bool bfs(int s, int t) {
+        fill(level.begin(), level.end(), -1);
+        bfs_queue.clear();
+        bfs_queue.push_back(s);
+        level[s] = 0;
+        if constexpr (FlowStats::ENABLED)
+            bfs_scanned = 0;
+        for (size_t head = 0; head < bfs_queue.size() && level[t] == -1; head++) {
+            int u = bfs_queue[head];
+            if constexpr (FlowStats::ENABLED)
+                bfs_scanned += g.off[u + 1] - g.off[u];
+            for (Index i = g.off[u]; i < g.off[u + 1]; i++) {
+                Edge &e = g.arcs[i];
+                if (level[e.v] == -1 && e.res >= delta) {
+                    level[e.v] = level[u] + 1;
+                    bfs_queue.push_back(e.v);
+                    if ((int)e.v == t)
+                        break;
+                }
+            }
+        }
+        if (level[t] == -1)
+            return false;
+        if (sink_bfs)
+            pruneToSink(t);
+        return true;
+    }
+
+    // The sink_bfs pass: walk back from t over admissible arcs, one level down at a time, and
+    // unlabel every vertex bfs labelled that it does not reach.
+    void pruneToSink(int t) {
+        sink_queue.clear();
+        sink_queue.push_back(t);
+        on_path[t] = 1;
+        for (size_t head = 0; head < sink_queue.size(); head++) {
+            int u = sink_queue[head];
+            if (level[u] == 0)
+                continue;  // s; nothing lies below it
+            if constexpr (FlowStats::ENABLED)
+                bfs_scanned += g.off[u + 1] - g.off[u];
+            for (Index i = g.off[u]; i < g.off[u + 1]; i++) {
+                int w = g.arcs[i].v;
+                if (level[w] == level[u] - 1 && !on_path[w] && g.arcs[g.arcs[i].rev].res >= delta) {
+                    on_path[w] = 1;
+                    sink_queue.push_back(w);
+                }
+            }
+        }
+        for (int v : bfs_queue) {
+            if (!on_path[v])
+                level[v] = -1;
+            on_path[v] = 0;
+        }
+    }
+
+    // Single-path recursive DFS, kept for comparison; maxFlow uses blockingFlow. A vertex it
+    // returns from empty-handed is retired for the phase, like in blockingFlow.
+    Cap dfs(int u, int t, Cap flow) {
+        if (u == t) return flow;
+        for (; ptr[u] < g.off[u + 1]; ptr[u]++) {
+            Edge &e = g.arcs[ptr[u]];
+            if (level[e.v] == level[u] + 1 && e.res >= delta) {
+                Cap pushed = dfs(e.v, t, min(flow, e.res));
+                if (pushed > 0) {
+                    e.res -= pushed;
+                    g.arcs[e.rev].res += pushed;
+                    return pushed;
+                }
+            }
+        }
+        level[u] = -1;
+        return 0;
+    }
+
+    // ---------------- Blocking Flow (Iterative) ----------------
+    // Finds a blocking flow in the level graph without recursion. 'path' holds the arcs from s to
+    // the current vertex and ptr[] the current arc of every vertex. On reaching t the path is
+    // augmented by its bottleneck and the search retreats only to the tail of the first arc it
+    // saturated, so the flow still available on the rest of the path goes down the next branch
+    // instead of re-walking from s. A vertex whose arcs are exhausted is a dead end: the search
+    // retreats and the vertex loses its level for the rest of the phase, so the arcs into it from
+    // every other vertex fail the level test without the search stepping in again.
+    Flow blockingFlow(int s, int t) {
+        Flow total = 0;
+        path.clear();
+        int u = s;
+        while (true) {
+            if (u == t) {
+                Cap pushed = numeric_limits<Cap>::max();
+                for (Index a : path)
+                    pushed = min(pushed, g.arcs[a].res);
+                int saturated = -1;
+                for (int i = 0; i < (int)path.size(); i++) {
+                    Edge &e = g.arcs[path[i]];
+                    e.res -= pushed;
+                    g.arcs[e.rev].res += pushed;
+                    if (saturated == -1 && e.res < delta)
+                        saturated = i;
+                }
+                total += pushed;
+                if constexpr (FlowStats::ENABLED)
+                    paths_found++;
+                u = g.arcs[g.arcs[path[saturated]].rev].v;
+                path.resize(saturated);
+                continue;
+            }
+
+            Index &i = ptr[u];
+            while (i < g.off[u + 1] &&
+                   !(level[g.arcs[i].v] == level[u] + 1 && g.arcs[i].res >= delta))
+                i++;
+
+            if (i < g.off[u + 1]) {
+                path.push_back(i);
+                u = g.arcs[i].v;
+            } else {
+                if (u == s)
+                    break;
+                level[u] = -1;
+                Index a = path.back();
+                path.pop_back();
+                u = g.arcs[g.arcs[a].rev].v;
+                ptr[u]++;
+            }
+        }
+        return total;
+    }
+
+    // Phases and time spent building level graphs and pushing blocking flows in the last maxFlow.
+    int phases = 0;
+    double bfs_ms = 0, dfs_ms = 0;
+    // Per-phase counters and timings of the last maxFlow; filled in only when built with
+    // FLOW_STATS (see flowstats.h).
+    FlowStats stats;
+
+    Flow maxFlow(int s, int t) {
+        finalize();
+        g.repairFlow(s, t);
+        phases = 0;
+        bfs_ms = dfs_ms = 0;
+        if constexpr (FlowStats::ENABLED)
+            stats.clear();
+        Flow flow = g.outflow(s);
+        auto start = chrono::steady_clock::now(), t0 = start;
+        delta = scaling ? firstDelta(s, t) : UNIT;
+        while (true) {
+            if (!bfs(s, t)) {
+                if (delta == UNIT)
+                    break;
+                delta = delta > 1 ? delta / 2 : UNIT;
+                continue;
+            }
+            auto t1 = chrono::steady_clock::now();
+            copy(g.off.begin(), g.off.end() - 1, ptr.begin());
+            Flow pushed = blockingFlow(s, t);
+            flow += pushed;
+            auto t2 = chrono::steady_clock::now();
+            double phase_bfs = chrono::duration<double, milli>(t1 - t0).count();
+            double phase_dfs = chrono::duration<double, milli>(t2 - t1).count();
+            bfs_ms += phase_bfs;
+            dfs_ms += phase_dfs;
+            phases++;
+            t0 = t2;
+            if constexpr (FlowStats::ENABLED) {
+                recordPhase(t, phase_bfs, phase_dfs, bfs_scanned, pushed);
+                t0 = chrono::steady_clock::now();  // keep the bookkeeping out of the next BFS
+            }
+        }
+        double last_bfs = msSince(t0);
+        bfs_ms += last_bfs;
+        if constexpr (FlowStats::ENABLED) {
+            stats.final_bfs_ms = last_bfs;
+            stats.final_bfs_arcs = bfs_scanned;
+            stats.total_ms = msSince(start);
+        }
+        return flow;
+    }
+
+    // First scaling threshold: the largest power of two not above the smaller of the largest
+    // residual out of s and the largest into t, which bound what any augmenting path carries.
+    // Only the terminals' arcs are scanned, not the whole graph.
+    Cap firstDelta(int s, int t) const {
+        Cap out = 0, in = 0;
+        for (Index a = g.off[s]; a < g.off[s + 1]; a++)
+            out = max(out, g.arcs[a].res);
+        for (Index a = g.off[t]; a < g.off[t + 1]; a++)
+            in = max(in, g.arcs[g.arcs[a].rev].res);
+        Cap top = min(out, in);
+        Cap d = 1;
+        while (d <= top / 2)
+            d *= 2;
+        return d;
+    }
+
+    void recordPhase(int t, double bfs, double dfs, long long bfs_arcs, Flow pushed) {
+        PhaseStats p;
+        p.bfs_ms = bfs;
+        p.dfs_ms = dfs;
+        p.bfs_arcs = bfs_arcs;
+        p.dfs_arcs = retiredArcs(g, ptr);
+        p.paths = paths_found;
+        p.flow = (double)pushed;
+        p.sink_level = level[t];
+        stats.phases.push_back(p);
+        paths_found = 0;
+    }
+
+    // ---------------- Results ----------------
+    typedef BasicFlowResult<Cap, Index> Result;
+
+    // maxFlow plus the minimum cut and a view of the arc flows (see flowresult.h). The last BFS
+    // of maxFlow failed to reach t, so its levels already mark the source side. The cut is
+    // extracted on 'pool', or on a temporary one for large graphs if none is given.
+    Result solve(int s, int t, WorkerPool *pool = nullptr) {
+        Flow flow = maxFlow(s, t);
+        return makeFlowResult(g, flow, [&](int v) { return level[v] != -1; }, pool);
+    }
+};
+
+typedef BasicDinic<> Dinic;
+
+} // namespace orig
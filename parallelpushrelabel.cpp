@@ -0,0 +1,23 @@
+#include <iostream>
+#include <cstdlib>
+
+#include "parallelpushrelabel.h"
+#include "graphgen.h"
+
+using namespace std;
+
+int main() {
+    int V = 100000;
+    ParallelPushRelabel pr(V);
+    cout << "Number of nodes: " << V << endl;
+
+    // i -> i+1, i -> i+2 chain, seeded so every run builds the same graph.
+    addEdges(ChainGraph{V, 1}, pr);
+    pr.finalize();
+
+    cout << "Using " << NUM_THREADS << " threads for push-relabel." << endl;
+    cout << "Max Flow (Parallel Push-Relabel Algorithm): " << pr.maxFlow(0, V - 1) << endl;
+    cout << "Pushes: " << pr.pushes << ", relabels: " << pr.relabels
+         << ", global relabels: " << pr.global_relabels << ", rounds: " << pr.rounds << endl;
+    return 0;
+}
@@ -0,0 +1,343 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <algorithm>
+#include <climits>
+#include <chrono>
+
+#include "flowgraph.h"
+#include "flowresult.h"
+#include "flowstats.h"
+#include "workerpool.h"
+
+using namespace std;
+
+#define NUM_THREADS static_cast<int>(thread::hardware_concurrency())
+
+// Parallel Push-Relabel Algorithm (lock-free, after Hong and He)
+//
+// All pool workers discharge active vertices at the same time without locks. A vertex is owned by
+// the one worker that flipped its 'queued' flag, and only that worker lowers its excess or raises its
+// height. Each step reads the neighbours' heights (possibly stale) and picks the lowest residual one.
+// It pushes to it with atomic updates of the arc, the reverse arc and both excesses if u is higher,
+// and otherwise lifts u to one above it. Within a round heights only grow, so a stale height read
+// just costs u an extra step. A stale residual read can lift u too high, and the exact relabel that
+// ends every phase repairs that before the phase is allowed to finish.
+//
+// Work runs in rounds over the active list; vertices activated during a round are collected in
+// padded per-worker buffers for the next one. Between rounds, once enough relabels have piled up,
+// exact labels are recomputed by a parallel reverse BFS from t on the same pool. That pass is a
+// short lock-free sweep instead of a long sequential stop. Like PushRelabel, a second phase sends
+// stranded excess back to s so the arc flows form a valid flow.
+//
+// Capacity type Cap and arc index type Index as in BasicFlowGraph; excesses are kept in the wider
+// Flow type.
+template <class Cap = int, class Index = uint32_t>
+class BasicParallelPushRelabel {
+    typedef BasicFlowGraph<Cap, Index> Graph;
+    typedef typename Graph::Edge Edge;
+    typedef typename Graph::Flow Flow;
+    int V;
+    Graph g;
+    WorkerPool pool;
+    vector<Flow> excess;
+    vector<int> height;
+    vector<char> queued;             // vertex is in an active list or being discharged
+    vector<int> active;
+    vector<WorkerBuffer> next_active;
+    // globalRelabel scratch: BFS distances (all -1 between calls), the frontier and each worker's
+    // share of the next one.
+    vector<int> dist, relabel_frontier;
+    vector<WorkerBuffer> relabel_next;
+    atomic<long long> relabels_since_update{0};
+    int limit;                       // vertices at or above this height are out of the current phase
+    int stats_t;                     // sink of the running maxFlow, for the stats' flow column
+    chrono::steady_clock::time_point stats_start, phase_start;
+
+    static const int UNREACHED = INT_MAX / 2;
+
+public:
+    // Counters of the last maxFlow call.
+    atomic<long long> pushes{0}, relabels{0};
+    long long global_relabels = 0, rounds = 0;
+    // Per-phase counters and timings, a phase ending at each global relabel; filled in only when
+    // built with FLOW_STATS (see flowstats.h).
+    FlowStats stats;
+
+    BasicParallelPushRelabel(int V, int num_threads = NUM_THREADS)
+        : V(V), g(V), pool(num_threads), excess(V), height(V), queued(V), next_active(pool.size()),
+          dist(V, -1), relabel_next(pool.size()) {}
+
+    void addEdge(int u, int v, Cap cap) {
+        g.addEdge(u, v, cap);
+    }
+
+    // Bulk form of addEdge for loaders; takes over the list.
+    void addEdges(vector<typename Graph::InputEdge> &&edges) {
+        g.addEdges(move(edges));
+    }
+
+    // Freeze the added edges into the CSR arc array, on the solver's pool when there are many.
+    // maxFlow calls it if the caller didn't.
+    void finalize() {
+        g.finalize(&pool);
+    }
+
+    // Save the finalized graph as a binary snapshot, or open one instead of adding edges
+    // (see FlowGraph). The snapshot must have this solver's vertex count.
+    void saveSnapshot(const string &path) {
+        finalize();
+        g.saveSnapshot(path);
+    }
+
+    void openSnapshot(const string &path) {
+        g.openSnapshot(path);
+    }
+
+    Flow maxFlow(int s, int t) {
+        finalize();
+        pushes = relabels = 0;
+        global_relabels = rounds = 0;
+        if constexpr (FlowStats::ENABLED) {
+            stats.clear();
+            stats_start = chrono::steady_clock::now();
+            stats_t = t;
+        }
+        g.resetFlow();
+        fill(excess.begin(), excess.end(), 0);
+        fill(queued.begin(), queued.end(), 0);
+
+        // Saturate every arc out of the source.
+        active.clear();
+        for (Index i = g.off[s]; i < g.off[s + 1]; i++) {
+            Edge &e = g.arcs[i];
+            Cap c = e.res;
+            excess[s] -= c;
+            excess[e.v] += c;
+            g.arcs[e.rev].res += c;
+            e.res = 0;
+            if ((int)e.v != s && (int)e.v != t && !queued[e.v] && c > 0) {
+                queued[e.v] = 1;
+                active.push_back(e.v);
+            }
+        }
+
+        // Phase one: maximum preflow, labels are distances to t.
+        limit = V;
+        runRounds(s, t, V);
+
+        // Phase two: return stranded excess, labels are distances to s and t is closed off.
+        limit = UNREACHED;
+        active.clear();
+        for (int u = 0; u < V; u++) {
+            queued[u] = (u != s && u != t && excess[u] > 0);
+            if (queued[u])
+                active.push_back(u);
+        }
+        runRounds(t, s, UNREACHED);
+
+        if constexpr (FlowStats::ENABLED) {
+            endPhase(t);
+            stats.global_relabels = global_relabels;
+            stats.rounds = rounds;
+            stats.total_ms = msSince(stats_start);
+        }
+        return excess[t];
+    }
+
+    typedef BasicFlowResult<Cap, Index> Result;
+
+    // maxFlow plus the minimum cut and a view of the arc flows (see flowresult.h). The source side
+    // is the part of the residual graph s still reaches, found by a parallel BFS on the pool.
+    Result solve(int s, int t) {
+        Flow flow = maxFlow(s, t);
+        return makeFlowResult(g, flow, s, &pool);
+    }
+
+private:
+    static int load(const int &x) { return __atomic_load_n(&x, __ATOMIC_RELAXED); }
+
+    // Process the active list round by round, pushing towards 'target'. When it runs dry, exact
+    // labels are recomputed and any vertex that still has excess and can reach the target is picked
+    // up again, so a label that a stale read pushed too high cannot strand flow.
+    void runRounds(int other, int target, int unreached) {
+        globalRelabel(target, other, unreached);
+        while (true) {
+            while (!active.empty()) {
+                rounds++;
+                int n = active.size();
+                int num_chunks = min(pool.size() * 8, max(1, n / 64));
+                int chunk_size = (n + num_chunks - 1) / num_chunks;
+                for (auto &buf : next_active)
+                    buf.items.clear();
+                pool.run(num_chunks, [&](int c, int worker_id) {
+                    int end = min((c + 1) * chunk_size, n);
+                    for (int i = c * chunk_size; i < end; i++)
+                        discharge(active[i], other, target, worker_id);
+                });
+
+                active.clear();
+                for (auto &buf : next_active)
+                    active.insert(active.end(), buf.items.begin(), buf.items.end());
+
+                if (relabels_since_update.load() > V / 2)
+                    globalRelabel(target, other, unreached);
+            }
+
+            globalRelabel(target, other, unreached);
+            for (int u = 0; u < V; u++) {
+                if (u != other && u != target && excess[u] > 0 && height[u] < limit) {
+                    queued[u] = 1;
+                    active.push_back(u);
+                }
+            }
+            if (active.empty())
+                break;
+        }
+    }
+
+    void enqueue(int v, int worker_id) {
+        char expected = 0;
+        if (__atomic_compare_exchange_n(&queued[v], &expected, 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+            next_active[worker_id].items.push_back(v);
+    }
+
+    // Discharge u, which this worker owns until it clears queued[u].
+    void discharge(int u, int s, int t, int worker_id) {
+        long long local_pushes = 0, local_relabels = 0;
+        while (true) {
+            Flow ex = atomicLoad(excess[u], __ATOMIC_SEQ_CST);
+            int hu = height[u];
+            if (ex <= 0 || hu >= limit)
+                break;
+
+            Index end = g.off[u + 1], best = end;
+            int best_height = INT_MAX;
+            for (Index i = g.off[u]; i < end; i++) {
+                Edge &e = g.arcs[i];
+                if (atomicLoad(e.res) > 0) {
+                    int h = load(height[e.v]);
+                    if (h < best_height) {
+                        best_height = h;
+                        best = i;
+                    }
+                }
+            }
+            if (best == end)
+                break;
+
+            if (hu > best_height) {
+                Edge &e = g.arcs[best];
+                Cap d = (Cap)min(ex, (Flow)atomicLoad(e.res));
+                atomicSub(e.res, d);
+                atomicAdd(g.arcs[e.rev].res, d);
+                atomicSub(excess[u], (Flow)d, __ATOMIC_SEQ_CST);
+                atomicAdd(excess[e.v], (Flow)d, __ATOMIC_SEQ_CST);
+                if ((int)e.v != s && (int)e.v != t)
+                    enqueue(e.v, worker_id);
+                local_pushes++;
+            } else {
+                __atomic_store_n(&height[u], min(best_height + 1, limit), __ATOMIC_RELAXED);
+                local_relabels++;
+            }
+        }
+
+        // Release u; a push that raced with the release re-activates it for the next round.
+        __atomic_store_n(&queued[u], 0, __ATOMIC_SEQ_CST);
+        if (atomicLoad(excess[u], __ATOMIC_SEQ_CST) > 0 && height[u] < limit)
+            enqueue(u, worker_id);
+
+        pushes += local_pushes;
+        relabels += local_relabels;
+        relabels_since_update += local_relabels;
+    }
+
+    // Exact labels by a parallel reverse BFS from 'root' over arcs with residual capacity, never
+    // entering 'closed'. Vertices that are not reached, and 'closed' itself, get 'unreached'.
+    // It only runs between rounds, so no discharge sees a label go down.
+    void globalRelabel(int root, int closed, int unreached) {
+        if constexpr (FlowStats::ENABLED) {
+            endPhase(stats_t);
+            phase_start = chrono::steady_clock::now();
+        }
+        global_relabels++;
+        relabels_since_update = 0;
+        dist[root] = 0;
+        dist[closed] = unreached;
+        vector<int> &frontier = relabel_frontier;
+        frontier.assign(1, root);
+        long long bfs_arcs = 0;
+        int depth = -1;
+
+        while (!frontier.empty()) {
+            for (auto &lf : relabel_next)
+                lf.items.clear();
+            int f_size = frontier.size();
+            int num_chunks = min(pool.size(), max(1, f_size / 500));
+            int chunk_size = (f_size + num_chunks - 1) / num_chunks;
+            pool.run(num_chunks, [&](int c, int worker_id) {
+                int end = min((c + 1) * chunk_size, f_size);
+                for (int k = c * chunk_size; k < end; k++) {
+                    int u = frontier[k];
+                    for (Index i = g.off[u]; i < g.off[u + 1]; i++) {
+                        int w = g.arcs[i].v;
+                        Edge &in = g.arcs[g.arcs[i].rev];  // w -> u
+                        if (in.res > 0 && __atomic_load_n(&dist[w], __ATOMIC_RELAXED) == -1) {
+                            int expected = -1;
+                            if (__atomic_compare_exchange_n(&dist[w], &expected, dist[u] + 1, false,
+                                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                                relabel_next[worker_id].items.push_back(w);
+                        }
+                    }
+                }
+            });
+            if constexpr (FlowStats::ENABLED) {
+                for (int u : frontier)
+                    bfs_arcs += g.off[u + 1] - g.off[u];
+                depth++;
+            }
+            frontier.clear();
+            for (auto &lf : relabel_next)
+                frontier.insert(frontier.end(), lf.items.begin(), lf.items.end());
+        }
+
+        int num_chunks = min(pool.size() * 4, max(1, V / 4096));
+        int chunk_size = (V + num_chunks - 1) / num_chunks;
+        pool.run(num_chunks, [&](int c, int) {
+            int end = min((c + 1) * chunk_size, V);
+            for (int u = c * chunk_size; u < end; u++) {
+                height[u] = dist[u] == -1 ? unreached : dist[u];
+                dist[u] = -1;
+            }
+        });
+
+        if constexpr (FlowStats::ENABLED) {
+            PhaseStats p;
+            p.bfs_ms = msSince(phase_start);
+            p.bfs_arcs = bfs_arcs;
+            p.sink_level = depth;
+            p.pushes = pushes;  // counters at the start, until endPhase
+            p.relabels = relabels;
+            p.flow = (double)excess[stats_t];
+            stats.phases.push_back(p);
+            phase_start = chrono::steady_clock::now();
+        }
+    }
+
+    // Close the phase opened by the last global relabel.
+    void endPhase(int t) {
+        if (stats.phases.empty())
+            return;
+        PhaseStats &p = stats.phases.back();
+        p.dfs_ms = msSince(phase_start);
+        p.pushes = pushes - p.pushes;
+        p.relabels = relabels - p.relabels;
+        p.flow = (double)excess[t] - p.flow;
+    }
+};
+
+typedef BasicParallelPushRelabel<> ParallelPushRelabel;
@@ -0,0 +1,399 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "flowgraph.h"
+#include "flowresult.h"
+using namespace std;
+
+// Hochbaum's Pseudoflow Algorithm (HPF, highest-label variant)
+//
+// Phase one starts from a pseudoflow rather than a preflow. Every arc out of s and every arc
+// into t is saturated, so each vertex begins with an excess (strong) or a deficit (weak, label
+// 0). The vertices are kept in a normalized forest whose roots alone carry excess or deficit.
+// A strong root of the highest label h looks in its tree for a vertex of label h with a
+// residual arc to any vertex of label h - 1. If it finds one, the tree is re-rooted at that
+// vertex and hung from the arc (a merger). The root's excess then flows up the new path
+// towards the other tree's root. An arc that cannot carry all of it splits off the subtree
+// below it as a new strong root. A tree with no such arc has all its label-h vertices
+// relabelled, deepest first. If no vertex is left at label h - 1, the whole tree is cut off
+// from the sink and lifted to label V for good.
+//
+// Phase one ends when no strong root is left. The lifted vertices and s are then the source
+// side of a minimum cut, which is all minCut() needs. maxFlow() goes on with phase two, the
+// flow recovery. Excess on the source side returns to s and deficits on the sink side return
+// to t, each by FIFO discharge on exact distance labels, as in PushRelabel's phase two. The
+// arc flows then form a maximum flow across the same cut.
+//
+// Capacity type Cap and arc index type Index as in BasicFlowGraph; excesses are kept in the wider
+// Flow type.
+template <class Cap = int, class Index = uint32_t>
+class BasicPseudoflow {
+    typedef BasicFlowGraph<Cap, Index> Graph;
+    typedef typename Graph::Edge Edge;
+    typedef typename Graph::Flow Flow;
+    int V;
+    Graph g;
+    vector<Flow> excess;
+    vector<int> label, label_count;
+    vector<int> parent, first_child, next_sibling, prev_sibling, next_scan;
+    vector<Index> parent_arc;   // arc from a vertex to its parent
+    vector<Index> next_arc;     // merger search resumes here until the vertex is relabelled
+    vector<int> bucket_head, bucket_next;  // strong roots per label (stack)
+    int highest;                // highest possibly non-empty bucket
+
+    static const int SINK_LABEL = -2;  // never h - 1, so no merger ends at t
+
+public:
+    // Counters of the last minCut or maxFlow call.
+    long long mergers = 0, pushes = 0, relabels = 0, lifts = 0;
+
+    BasicPseudoflow(int V)
+        : V(V), g(V), excess(V), label(V), label_count(V + 2), parent(V), first_child(V),
+          next_sibling(V), prev_sibling(V), next_scan(V), parent_arc(V), next_arc(V),
+          bucket_head(V + 1), bucket_next(V) {}
+
+    void addEdge(int u, int v, Cap cap) {
+        g.addEdge(u, v, cap);
+    }
+
+    // Bulk form of addEdge for loaders; takes over the list.
+    void addEdges(vector<typename Graph::InputEdge> &&edges) {
+        g.addEdges(move(edges));
+    }
+
+    // Freeze the added edges into the CSR arc array. maxFlow calls it if the caller didn't.
+    void finalize() {
+        g.finalize();
+    }
+
+    // Save the finalized graph as a binary snapshot, or open one instead of adding edges
+    // (see FlowGraph). The snapshot must have this solver's vertex count.
+    void saveSnapshot(const string &path) {
+        finalize();
+        g.saveSnapshot(path);
+    }
+
+    void openSnapshot(const string &path) {
+        g.openSnapshot(path);
+    }
+
+    // Phase one only: the value of a minimum s-t cut, whose source side sourceSide() reports
+    // afterwards. The arc flows are left a pseudoflow, not a flow.
+    Flow minCut(int s, int t) {
+        finalize();
+        phaseOne(s, t);
+        Flow cut = 0;
+        for (int u = 0; u < V; u++) {
+            if (!sourceSide(u))
+                continue;
+            for (Index a = g.off[u]; a < g.off[u + 1]; a++)
+                if (!sourceSide(g.arcs[a].v))
+                    cut += g.cap[a];
+        }
+        return cut;
+    }
+
+    // Source side of the cut found by the last minCut or maxFlow.
+    bool sourceSide(int v) const { return label[v] == V; }
+
+    Flow maxFlow(int s, int t) {
+        finalize();
+        phaseOne(s, t);
+        settle(s, t, false);
+        settle(t, s, true);
+        return g.outflow(s);
+    }
+
+    typedef BasicFlowResult<Cap, Index> Result;
+
+    // maxFlow plus the minimum cut and a view of the arc flows (see flowresult.h). Flow recovery
+    // never moves flow across the phase-one cut, so its source side is used as it is.
+    Result solve(int s, int t) {
+        Flow flow = maxFlow(s, t);
+        return makeFlowResult(g, flow, [&](int v) { return sourceSide(v); });
+    }
+
+private:
+    // ---------------- Phase One ----------------
+    void phaseOne(int s, int t) {
+        mergers = pushes = relabels = lifts = 0;
+        g.resetFlow();
+        fill(excess.begin(), excess.end(), 0);
+        fill(parent.begin(), parent.end(), -1);
+        fill(first_child.begin(), first_child.end(), -1);
+        fill(label_count.begin(), label_count.end(), 0);
+        fill(bucket_head.begin(), bucket_head.end(), -1);
+
+        // Saturate the arcs out of s and into t.
+        for (Index a = g.off[s]; a < g.off[s + 1]; a++)
+            saturate(a);
+        for (int u = 0; u < V; u++) {
+            if (u == s || u == t)
+                continue;
+            for (Index a = g.off[u]; a < g.off[u + 1]; a++)
+                if ((int)g.arcs[a].v == t)
+                    saturate(a);
+        }
+
+        highest = 0;
+        for (int u = 0; u < V; u++) {
+            next_arc[u] = g.off[u];
+            if (u == s || u == t)
+                continue;
+            label[u] = excess[u] > 0 ? 1 : 0;
+            label_count[label[u]]++;
+            if (excess[u] > 0)
+                addStrongRoot(u);
+        }
+        label[s] = V;
+        label[t] = SINK_LABEL;
+
+        for (int r; (r = nextStrongRoot()) != -1;)
+            processRoot(r);
+    }
+
+    void saturate(Index a) {
+        Edge &e = g.arcs[a];
+        excess[g.arcs[e.rev].v] -= e.res;
+        excess[e.v] += e.res;
+        g.arcs[e.rev].res += e.res;
+        e.res = 0;
+    }
+
+    void addStrongRoot(int u) {
+        bucket_next[u] = bucket_head[label[u]];
+        bucket_head[label[u]] = u;
+        highest = max(highest, label[u]);
+    }
+
+    // Highest strong root that still has vertices one label below it to merge with. Roots above
+    // an empty label are lifted out instead: nothing they reach can take their excess to t.
+    int nextStrongRoot() {
+        for (; highest >= 0; highest--) {
+            while (bucket_head[highest] != -1) {
+                int r = bucket_head[highest];
+                bucket_head[highest] = bucket_next[r];
+                if (highest == 0 || label_count[highest - 1] > 0)
+                    return r;
+                liftAll(r);
+            }
+        }
+        return -1;
+    }
+
+    void attach(int child, int p, Index arc) {
+        parent[child] = p;
+        parent_arc[child] = arc;
+        prev_sibling[child] = -1;
+        next_sibling[child] = first_child[p];
+        if (first_child[p] != -1)
+            prev_sibling[first_child[p]] = child;
+        first_child[p] = child;
+    }
+
+    void detach(int child) {
+        int p = parent[child];
+        if (prev_sibling[child] != -1)
+            next_sibling[prev_sibling[child]] = next_sibling[child];
+        else
+            first_child[p] = next_sibling[child];
+        if (next_sibling[child] != -1)
+            prev_sibling[next_sibling[child]] = prev_sibling[child];
+        parent[child] = -1;
+    }
+
+    // Depth-first over the label-h part of r's tree (labels never drop away from the root, so
+    // that part hangs together below r). The first vertex with a merger arc ends the search.
+    // Every vertex without one and without label-h children left is relabelled on the way back.
+    void processRoot(int r) {
+        int u = r;
+        next_scan[u] = first_child[u];
+        if (tryMerge(r, u))
+            return;
+        checkChildren(u);
+        while (true) {
+            while (next_scan[u] != -1) {
+                int c = next_scan[u];
+                next_scan[u] = next_sibling[c];
+                u = c;
+                next_scan[u] = first_child[u];
+                if (tryMerge(r, u))
+                    return;
+                checkChildren(u);
+            }
+            if (u == r)
+                break;
+            u = parent[u];
+            checkChildren(u);
+        }
+        addStrongRoot(r);
+    }
+
+    // Advance u's scan to its next child with u's label, or relabel u when there is none.
+    void checkChildren(int u) {
+        for (; next_scan[u] != -1; next_scan[u] = next_sibling[next_scan[u]])
+            if (label[next_scan[u]] == label[u])
+                return;
+        label_count[label[u]]--;
+        label[u]++;
+        label_count[label[u]]++;
+        next_arc[u] = g.off[u];
+        relabels++;
+    }
+
+    // Look for a residual arc from u to a vertex of label h - 1 (h = label of u). Arcs passed
+    // over cannot become mergers while u keeps its label, so the search resumes where it left off.
+    bool tryMerge(int r, int u) {
+        int want = label[u] - 1;
+        Index end = g.off[u + 1];
+        for (Index &a = next_arc[u]; a < end; a++) {
+            Edge &e = g.arcs[a];
+            if (e.res > 0 && label[e.v] == want) {
+                merge(u, e.v, a);
+                pushExcess(r);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Re-root u's tree at u and hang it from w by arc a (u -> w).
+    void merge(int u, int w, Index a) {
+        mergers++;
+        int cur = u, new_parent = w;
+        Index new_arc = a;
+        while (parent[cur] != -1) {
+            int old_parent = parent[cur];
+            Index old_arc = parent_arc[cur];
+            detach(cur);
+            attach(cur, new_parent, new_arc);
+            new_parent = cur;
+            new_arc = g.arcs[old_arc].rev;
+            cur = old_parent;
+        }
+        attach(cur, new_parent, new_arc);
+    }
+
+    // Send r's excess up to the root of its tree. An arc too small for the excess below it is
+    // saturated and splits off that subtree, which keeps the rest as a new strong root.
+    void pushExcess(int r) {
+        int cur = r;
+        Flow before = 1;
+        while (excess[cur] > 0 && parent[cur] != -1) {
+            int p = parent[cur];
+            before = excess[p];
+            Edge &e = g.arcs[parent_arc[cur]];
+            Flow d = min(excess[cur], (Flow)e.res);
+            e.res -= (Cap)d;
+            g.arcs[e.rev].res += (Cap)d;
+            excess[cur] -= d;
+            excess[p] += d;
+            pushes++;
+            if (excess[cur] > 0) {
+                detach(cur);
+                addStrongRoot(cur);
+            }
+            cur = p;
+        }
+        if (parent[cur] == -1 && excess[cur] > 0 && before <= 0)
+            addStrongRoot(cur);
+    }
+
+    // Lift r's whole tree to label V: it is on the source side of the minimum cut.
+    void liftAll(int r) {
+        lifts++;
+        int u = r;
+        next_scan[u] = first_child[u];
+        label_count[label[u]]--;
+        label[u] = V;
+        while (true) {
+            while (next_scan[u] != -1) {
+                int c = next_scan[u];
+                next_scan[u] = next_sibling[c];
+                u = c;
+                next_scan[u] = first_child[u];
+                label_count[label[u]]--;
+                label[u] = V;
+            }
+            if (u == r)
+                break;
+            u = parent[u];
+        }
+    }
+
+    // ---------------- Phase Two: Flow Recovery ----------------
+    // Move every imbalance of one sign back to 'root': excess to s (deficit = false) or deficit
+    // to t (deficit = true). Excess moves along residual arcs. A deficit moves against arcs that
+    // carry flow, by taking that flow back. Labels are exact distances to the root over those
+    // arcs, 'other' is closed off, and active vertices are discharged FIFO. The imbalances of
+    // each sign stay on their side of the cut, so neither pass crosses it.
+    void settle(int root, int other, bool deficit) {
+        // The residual a move from tail(a) to head(a) uses up.
+        auto room = [&](Index a) -> Cap & { return deficit ? g.arcs[g.arcs[a].rev].res : g.arcs[a].res; };
+        auto imbalance = [&](int u) { return deficit ? -excess[u] : excess[u]; };
+
+        vector<int> &height = next_scan;  // free again after phase one
+        fill(height.begin(), height.end(), INT_MAX);
+        vector<int> q;
+        q.reserve(V);
+        q.push_back(root);
+        height[root] = 0;
+        for (size_t qi = 0; qi < q.size(); qi++) {
+            int u = q[qi];
+            for (Index a = g.off[u]; a < g.off[u + 1]; a++) {
+                int w = g.arcs[a].v;
+                if (height[w] == INT_MAX && w != other && room(g.arcs[a].rev) > 0) {
+                    height[w] = height[u] + 1;
+                    q.push_back(w);
+                }
+            }
+        }
+
+        deque<int> active;
+        vector<Index> &cur = next_arc;
+        for (int u = 0; u < V; u++) {
+            cur[u] = g.off[u];
+            if (u != root && u != other && imbalance(u) > 0)
+                active.push_back(u);
+        }
+        while (!active.empty()) {
+            int u = active.front();
+            active.pop_front();
+            while (imbalance(u) > 0) {
+                Index &i = cur[u];
+                if (i == g.off[u + 1]) {
+                    int min_height = INT_MAX;
+                    for (Index j = g.off[u]; j < g.off[u + 1]; j++)
+                        if (room(j) > 0 && (int)g.arcs[j].v != other)
+                            min_height = min(min_height, height[g.arcs[j].v]);
+                    height[u] = min_height + 1;
+                    i = g.off[u];
+                    relabels++;
+                    continue;
+                }
+                int w = g.arcs[i].v;
+                Cap &r = room(i);
+                if (r > 0 && w != other && height[w] == height[u] - 1) {
+                    Cap d = (Cap)min(imbalance(u), (Flow)r);
+                    Edge &e = g.arcs[i];
+                    if (deficit) {
+                        g.arcs[e.rev].res -= d;
+                        e.res += d;
+                    } else {
+                        e.res -= d;
+                        g.arcs[e.rev].res += d;
+                    }
+                    if (imbalance(w) <= 0 && imbalance(w) + d > 0 && w != root)
+                        active.push_back(w);
+                    excess[u] += deficit ? d : -d;
+                    excess[w] += deficit ? -d : d;
+                    pushes++;
+                } else {
+                    i++;
+                }
+            }
+        }
+    }
+};
+
+typedef BasicPseudoflow<> Pseudoflow;
@@ -0,0 +1,21 @@
+#include <bits/stdc++.h>
+
+#include "pushrelabel.h"
+#include "graphgen.h"
+
+using namespace std;
+
+int main() {
+    int V = 100000;
+    PushRelabel pr(V);
+    cout << "Number of nodes: " << V << endl;
+
+    // i -> i+1, i -> i+2 chain, seeded so every run builds the same graph.
+    addEdges(ChainGraph{V, 1}, pr);
+    pr.finalize();
+
+    cout << "Max Flow (Push-Relabel Algorithm): " << pr.maxFlow(0, V - 1) << endl;
+    cout << "Pushes: " << pr.pushes << ", relabels: " << pr.relabels
+         << ", global relabels: " << pr.global_relabels << ", gaps: " << pr.gaps << endl;
+    return 0;
+}
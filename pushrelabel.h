@@ -0,0 +1,348 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include "flowgraph.h"
+#include "flowresult.h"
+#include "flowstats.h"
+using namespace std;
+
+// Push-Relabel Algorithm (highest-label, with global relabeling and the gap heuristic)
+//
+// Phase one discharges active vertices highest label first. Each height has a bucket of active
+// vertices and a doubly linked list of all vertices, so the next vertex to work on is found without
+// sweeping 0..V-1. Every vertex keeps a current-arc pointer. Exact distance labels are recomputed
+// periodically by a reverse BFS from the sink. When a relabel empties a height, every vertex above
+// that height is cut off from the sink and jumps to V. Phase one ends with a maximum preflow: the
+// excess at t is the max flow value. Phase two sends the excess stranded at cut-off vertices back
+// to the source, so the arc flows form a valid flow.
+//
+// Capacity type Cap and arc index type Index as in BasicFlowGraph; excesses are kept in the wider
+// Flow type.
+template <class Cap = int, class Index = uint32_t>
+class BasicPushRelabel {
+    typedef BasicFlowGraph<Cap, Index> Graph;
+    typedef typename Graph::Edge Edge;
+    typedef typename Graph::Flow Flow;
+    int V;
+    Graph g;
+    vector<Flow> excess;
+    vector<int> height;
+    vector<Index> cur;
+    vector<int> active_head, active_next;            // active vertices per height (stack)
+    vector<int> all_head, all_next, all_prev;        // all vertices per height (doubly linked)
+    int max_active, max_height;                      // highest possibly non-empty buckets
+    long long work_since_update;
+    chrono::steady_clock::time_point stats_start, phase_start;
+
+    // Global relabel frequency, as in Cherkassky and Goldberg's hi_pr.
+    static const int GLOBAL_ALPHA = 6;
+    static const int GLOBAL_BETA = 12;
+
+public:
+    // Counters of the last maxFlow call.
+    long long pushes = 0, relabels = 0, global_relabels = 0, gaps = 0;
+    // Per-phase counters and timings, a phase ending at each global relabel; filled in only when
+    // built with FLOW_STATS (see flowstats.h).
+    FlowStats stats;
+
+    BasicPushRelabel(int V)
+        : V(V), g(V), excess(V), height(V), cur(V), active_head(V + 1), active_next(V),
+          all_head(V + 1), all_next(V), all_prev(V) {}
+
+    void addEdge(int u, int v, Cap cap) {
+        g.addEdge(u, v, cap);
+    }
+
+    // Bulk form of addEdge for loaders; takes over the list.
+    void addEdges(vector<typename Graph::InputEdge> &&edges) {
+        g.addEdges(move(edges));
+    }
+
+    // Freeze the added edges into the CSR arc array. maxFlow calls it if the caller didn't.
+    void finalize() {
+        g.finalize();
+    }
+
+    // Save the finalized graph as a binary snapshot, or open one instead of adding edges
+    // (see FlowGraph). The snapshot must have this solver's vertex count.
+    void saveSnapshot(const string &path) {
+        finalize();
+        g.saveSnapshot(path);
+    }
+
+    void openSnapshot(const string &path) {
+        g.openSnapshot(path);
+    }
+
+    Flow maxFlow(int s, int t) {
+        finalize();
+        pushes = relabels = global_relabels = gaps = 0;
+        if constexpr (FlowStats::ENABLED) {
+            stats.clear();
+            stats_start = chrono::steady_clock::now();
+        }
+        g.resetFlow();
+        fill(excess.begin(), excess.end(), 0);
+
+        // Saturate every arc out of the source.
+        for (Index i = g.off[s]; i < g.off[s + 1]; i++) {
+            Edge &e = g.arcs[i];
+            excess[s] -= e.res;
+            excess[e.v] += e.res;
+            g.arcs[e.rev].res += e.res;
+            e.res = 0;
+        }
+
+        globalRelabel(s, t);
+        while (max_active >= 0) {
+            int u = active_head[max_active];
+            if (u == -1) {
+                max_active--;
+                continue;
+            }
+            active_head[max_active] = active_next[u];
+            if (height[u] >= V)
+                continue;  // cut off by a gap after it was queued; phase one is done with it
+            discharge(u, t);
+            if (work_since_update > (long long)GLOBAL_ALPHA * V + (long long)g.off[V] / 2)
+                globalRelabel(s, t);
+        }
+
+        if constexpr (FlowStats::ENABLED)
+            endPhase(t);
+        returnExcess(s, t);
+        if constexpr (FlowStats::ENABLED) {
+            stats.global_relabels = global_relabels;
+            stats.gaps = gaps;
+            stats.total_ms = msSince(stats_start);
+        }
+        return excess[t];
+    }
+
+    typedef BasicFlowResult<Cap, Index> Result;
+
+    // maxFlow plus the minimum cut and a view of the arc flows (see flowresult.h). The source side
+    // is the part of the residual graph s still reaches, found by a BFS once the flow is final.
+    Result solve(int s, int t) {
+        Flow flow = maxFlow(s, t);
+        return makeFlowResult(g, flow, s);
+    }
+
+private:
+    void activate(int v) {
+        active_next[v] = active_head[height[v]];
+        active_head[height[v]] = v;
+        max_active = max(max_active, height[v]);
+    }
+
+    void addToBucket(int v) {
+        int h = height[v];
+        all_prev[v] = -1;
+        all_next[v] = all_head[h];
+        if (all_head[h] != -1)
+            all_prev[all_head[h]] = v;
+        all_head[h] = v;
+        max_height = max(max_height, h);
+    }
+
+    void removeFromBucket(int v) {
+        if (all_prev[v] != -1)
+            all_next[all_prev[v]] = all_next[v];
+        else
+            all_head[height[v]] = all_next[v];
+        if (all_next[v] != -1)
+            all_prev[all_next[v]] = all_prev[v];
+    }
+
+    // Exact distance labels by reverse BFS from t over arcs with residual capacity. Vertices that
+    // cannot reach t get height V and take no further part in phase one.
+    void globalRelabel(int s, int t) {
+        if constexpr (FlowStats::ENABLED) {
+            endPhase(t);
+            phase_start = chrono::steady_clock::now();
+        }
+        global_relabels++;
+        work_since_update = 0;
+        fill(height.begin(), height.end(), V);
+        fill(active_head.begin(), active_head.end(), -1);
+        fill(all_head.begin(), all_head.end(), -1);
+        max_active = max_height = -1;
+
+        vector<int> q;
+        q.reserve(V);
+        q.push_back(t);
+        height[t] = 0;
+        for (size_t qi = 0; qi < q.size(); qi++) {
+            int u = q[qi];
+            for (Index i = g.off[u]; i < g.off[u + 1]; i++) {
+                int w = g.arcs[i].v;
+                Edge &in = g.arcs[g.arcs[i].rev];  // w -> u
+                if (height[w] == V && w != s && in.res > 0) {
+                    height[w] = height[u] + 1;
+                    q.push_back(w);
+                }
+            }
+        }
+
+        for (int u : q) {
+            cur[u] = g.off[u];
+            if (u == t)
+                continue;
+            addToBucket(u);
+            if (excess[u] > 0)
+                activate(u);
+        }
+
+        if constexpr (FlowStats::ENABLED) {
+            PhaseStats p;
+            p.bfs_ms = msSince(phase_start);
+            for (int u : q)
+                p.bfs_arcs += g.off[u + 1] - g.off[u];
+            p.sink_level = max_height;
+            p.pushes = pushes;  // counters at the start, until endPhase
+            p.relabels = relabels;
+            p.flow = (double)excess[t] - p.flow;
+            stats.phases.push_back(p);
+            phase_start = chrono::steady_clock::now();
+        }
+    }
+
+    // Close the phase opened by the last global relabel.
+    void endPhase(int t) {
+        if (stats.phases.empty())
+            return;
+        PhaseStats &p = stats.phases.back();
+        p.dfs_ms = msSince(phase_start);
+        p.pushes = pushes - p.pushes;
+        p.relabels = relabels - p.relabels;
+        p.flow = (double)excess[t] - p.flow;
+    }
+
+    void push(int u, Edge &e, int t) {
+        Cap d = (Cap)min(excess[u], (Flow)e.res);
+        e.res -= d;
+        g.arcs[e.rev].res += d;
+        excess[u] -= d;
+        if (excess[e.v] == 0 && (int)e.v != t)
+            activate(e.v);
+        excess[e.v] += d;
+        pushes++;
+    }
+
+    // Lift u to one above its lowest residual neighbour; the current arc restarts at that neighbour.
+    void relabel(int u) {
+        relabels++;
+        work_since_update += GLOBAL_BETA + (g.off[u + 1] - g.off[u]);
+        int min_height = V;
+        Index min_arc = g.off[u];
+        for (Index i = g.off[u]; i < g.off[u + 1]; i++) {
+            Edge &e = g.arcs[i];
+            if (e.res > 0 && height[e.v] < min_height) {
+                min_height = height[e.v];
+                min_arc = i;
+            }
+        }
+        height[u] = min(V, min_height + 1);
+        cur[u] = min_arc;
+    }
+
+    // Every vertex above an emptied height h can no longer reach t: move them all to V.
+    void gap(int h) {
+        gaps++;
+        for (int k = h + 1; k <= max_height; k++) {
+            for (int v = all_head[k]; v != -1; v = all_next[v])
+                height[v] = V;
+            all_head[k] = -1;
+        }
+        max_height = h - 1;
+    }
+
+    void discharge(int u, int t) {
+        while (excess[u] > 0) {
+            Index end = g.off[u + 1];
+            for (Index &i = cur[u]; i < end; i++) {
+                Edge &e = g.arcs[i];
+                if (e.res > 0 && height[u] == height[e.v] + 1) {
+                    push(u, e, t);
+                    if (excess[u] == 0)
+                        break;
+                }
+            }
+            if (excess[u] == 0)
+                break;
+
+            int old = height[u];
+            removeFromBucket(u);
+            relabel(u);
+            if (all_head[old] == -1) {
+                height[u] = V;
+                gap(old);
+            }
+            if (height[u] >= V)
+                break;
+            addToBucket(u);
+        }
+    }
+
+    // Phase two: excess left on vertices cut off from t returns to s. Labels are distances to s
+    // in the residual graph and active vertices are discharged FIFO.
+    void returnExcess(int s, int t) {
+        fill(height.begin(), height.end(), INT_MAX);
+        vector<int> q;
+        q.reserve(V);
+        q.push_back(s);
+        height[s] = 0;
+        for (size_t qi = 0; qi < q.size(); qi++) {
+            int u = q[qi];
+            for (Index i = g.off[u]; i < g.off[u + 1]; i++) {
+                int w = g.arcs[i].v;
+                Edge &in = g.arcs[g.arcs[i].rev];
+                if (height[w] == INT_MAX && w != t && in.res > 0) {
+                    height[w] = height[u] + 1;
+                    q.push_back(w);
+                }
+            }
+        }
+
+        deque<int> active;
+        for (int u = 0; u < V; u++) {
+            cur[u] = g.off[u];
+            if (u != s && u != t && excess[u] > 0)
+                active.push_back(u);
+        }
+        while (!active.empty()) {
+            int u = active.front();
+            active.pop_front();
+            while (excess[u] > 0) {
+                Index &i = cur[u];
+                if (i == g.off[u + 1]) {
+                    int min_height = INT_MAX;
+                    for (Index j = g.off[u]; j < g.off[u + 1]; j++) {
+                        Edge &e = g.arcs[j];
+                        if (e.res > 0 && (int)e.v != t)
+                            min_height = min(min_height, height[e.v]);
+                    }
+                    height[u] = min_height + 1;
+                    i = g.off[u];
+                    relabels++;
+                    continue;
+                }
+                Edge &e = g.arcs[i];
+                if (e.res > 0 && (int)e.v != t && height[e.v] == height[u] - 1) {
+                    Cap d = (Cap)min(excess[u], (Flow)e.res);
+                    e.res -= d;
+                    g.arcs[e.rev].res += d;
+                    excess[u] -= d;
+                    if (excess[e.v] == 0 && (int)e.v != s)
+                        active.push_back(e.v);
+                    excess[e.v] += d;
+                    pushes++;
+                } else {
+                    i++;
+                }
+            }
+        }
+    }
+};
+
+typedef BasicPushRelabel<> PushRelabel;
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include "flowgraph.h"
+#include "flowresult.h"
+
+using namespace std;
+
+// ---------------- Vertex Reordering ----------------
+// Solvers index level[], ptr[], excess[] and the CSR offsets by vertex id, so on a graph whose
+// ids were handed out in no useful order every BFS step and every DFS advance lands somewhere
+// new in memory. Renumbering the vertices so that neighbours get nearby ids keeps a search's
+// frontier, and the arcs it scans, in a few cache lines instead of one per vertex:
+//
+//   BFS_ORDER     breadth-first order from s over the undirected graph: a BFS from s then walks
+//                 the arrays almost sequentially, level after level
+//   RCM_ORDER     reverse Cuthill-McKee: BFS from a low-degree vertex of each component, with
+//                 neighbours taken lowest degree first, reversed; keeps every arc's endpoints
+//                 close together (small bandwidth)
+//   DEGREE_ORDER  highest degree first, which packs the hubs of a scale-free graph into the
+//                 first cache lines, where most arcs lead
+//
+// vertexOrder returns new_id[v] for every vertex. Reordered<Solver> wraps any solver with it.
+enum VertexOrder { ORIGINAL_ORDER, BFS_ORDER, RCM_ORDER, DEGREE_ORDER };
+
+namespace reorder_detail {
+
+// Undirected adjacency of the edge list in CSR form, both directions of every edge.
+struct Adjacency {
+    vector<size_t> off;
+    vector<int> adj;
+
+    template <class Cap>
+    Adjacency(int V, const vector<FlowInputEdge<Cap>> &edges) : off(V + 1, 0), adj(2 * edges.size()) {
+        for (auto &e : edges) {
+            off[e.u + 1]++;
+            off[e.v + 1]++;
+        }
+        for (int v = 0; v < V; v++)
+            off[v + 1] += off[v];
+        vector<size_t> pos(off.begin(), off.end() - 1);
+        for (auto &e : edges) {
+            adj[pos[e.u]++] = e.v;
+            adj[pos[e.v]++] = e.u;
+        }
+    }
+
+    size_t degree(int v) const { return off[v + 1] - off[v]; }
+};
+
+// Append the BFS order from 'root' to 'order', marking the vertices it visits. With by_degree
+// the unvisited neighbours of each vertex are queued lowest degree first (Cuthill-McKee).
+inline void bfsFrom(const Adjacency &g, int root, bool by_degree, vector<char> &seen,
+                    vector<int> &order) {
+    size_t head = order.size();
+    order.push_back(root);
+    seen[root] = 1;
+    for (; head < order.size(); head++) {
+        int u = order[head];
+        size_t first = order.size();
+        for (size_t i = g.off[u]; i < g.off[u + 1]; i++) {
+            int w = g.adj[i];
+            if (!seen[w]) {
+                seen[w] = 1;
+                order.push_back(w);
+            }
+        }
+        if (by_degree)
+            stable_sort(order.begin() + first, order.end(),
+                        [&](int a, int b) { return g.degree(a) < g.degree(b); });
+    }
+}
+
+} // namespace reorder_detail
+
+// new_id[v] for every vertex v under 'order'; s is the BFS_ORDER root. Vertices a BFS does not
+// reach follow in components, each from its lowest original id.
+template <class Cap>
+vector<int> vertexOrder(int V, const vector<FlowInputEdge<Cap>> &edges, VertexOrder order, int s = 0) {
+    vector<int> by_position;  // old id at each new position
+    if (order == ORIGINAL_ORDER) {
+        by_position.resize(V);
+        iota(by_position.begin(), by_position.end(), 0);
+    } else {
+        reorder_detail::Adjacency g(V, edges);
+        by_position.reserve(V);
+        if (order == DEGREE_ORDER) {
+            by_position.resize(V);
+            iota(by_position.begin(), by_position.end(), 0);
+            stable_sort(by_position.begin(), by_position.end(),
+                        [&](int a, int b) { return g.degree(a) > g.degree(b); });
+        } else {
+            vector<char> seen(V, 0);
+            bool rcm = order == RCM_ORDER;
+            if (!rcm && V > 0)
+                reorder_detail::bfsFrom(g, s, false, seen, by_position);
+            // Remaining components. RCM starts each at its lowest-degree vertex, a cheap stand-in
+            // for a pseudo-peripheral one.
+            vector<int> starts(V);
+            iota(starts.begin(), starts.end(), 0);
+            if (rcm)
+                stable_sort(starts.begin(), starts.end(),
+                            [&](int a, int b) { return g.degree(a) < g.degree(b); });
+            for (int v : starts)
+                if (!seen[v])
+                    reorder_detail::bfsFrom(g, v, rcm, seen, by_position);
+            if (rcm)
+                reverse(by_position.begin(), by_position.end());
+        }
+    }
+    vector<int> new_id(V);
+    for (int i = 0; i < V; i++)
+        new_id[by_position[i]] = i;
+    return new_id;
+}
+
+// ---------------- Reordered Solver ----------------
+// Any solver behind a vertex renumbering. Edges are collected with their original ids and handed
+// to the solver renumbered at the first finalize() or maxFlow(), so the solver's arrays follow
+// the new order. BFS_ORDER needs the source, so it waits for maxFlow(s, t); the other orders are
+// built by finalize(). Everything that comes back is in original ids: edge ids are kept (edges go
+// in in the order they were added), and solve()'s source side and arc endpoints are translated.
+//
+//   Reordered<orig::Dinic> d(V, RCM_ORDER);
+//   d.addEdge(u, v, cap);
+//   d.maxFlow(s, t);
+//   d.solver().phases;   // the wrapped solver, in new ids
+template <class Solver>
+class Reordered {
+public:
+    typedef typename Solver::Result Result;
+    typedef decltype(declval<Result>().flow) Flow;
+    typedef decltype(declval<Result>().arc_flows.capacity(0)) Cap;
+    typedef FlowInputEdge<Cap> InputEdge;
+
+    template <class... Args>
+    Reordered(int V, VertexOrder order, Args &&...args)
+        : V(V), order(order), inner(V, forward<Args>(args)...) {}
+
+    Solver &solver() { return inner; }
+
+    // Renumbering in effect once the edges have been handed over, empty before.
+    const vector<int> &newIds() const { return new_id; }
+    const vector<int> &oldIds() const { return old_id; }
+
+    size_t addEdge(int u, int v, Cap cap) {
+        if (!built) {
+            staged.push_back({u, v, cap});
+            return staged.size() - 1;
+        }
+        return inner.addEdge(new_id[u], new_id[v], cap);
+    }
+
+    void addEdges(vector<InputEdge> &&edges) {
+        if (built) {
+            for (auto &e : edges)
+                inner.addEdge(new_id[e.u], new_id[e.v], e.cap);
+        } else if (staged.empty()) {
+            staged.swap(edges);
+        } else {
+            staged.insert(staged.end(), edges.begin(), edges.end());
+        }
+        vector<InputEdge>().swap(edges);
+    }
+
+    void finalize() {
+        if (order != BFS_ORDER)
+            build(0);
+        if (built)
+            inner.finalize();
+    }
+
+    Flow maxFlow(int s, int t) {
+        build(s);
+        return inner.maxFlow(new_id[s], new_id[t]);
+    }
+
+    // solve() of the wrapped solver with the source side and arc endpoints in original ids.
+    // cut_arcs and arc_flows still index the solver's own arcs.
+    template <class... Args>
+    Result solve(int s, int t, Args &&...args) {
+        build(s);
+        Result r = inner.solve(new_id[s], new_id[t], forward<Args>(args)...);
+        vector<uint64_t> side((V + 63) / 64, 0);
+        for (int v = 0; v < V; v++)
+            if (r.sourceSide(new_id[v]))
+                side[v >> 6] |= (uint64_t)1 << (v & 63);
+        r.source_side.swap(side);
+        r.arc_flows.mapVertices(old_id.data());
+        return r;
+    }
+
+    // Incremental updates by edge id, for solvers that have them (see Dinic).
+    void setCapacity(size_t edge, Cap cap) {
+        if (built)
+            inner.setCapacity(edge, cap);
+        else
+            staged[edge].cap = cap;
+    }
+
+    void removeEdge(size_t edge) {
+        if (built)
+            inner.removeEdge(edge);
+        else
+            staged[edge].cap = 0;
+    }
+
+    Flow edgeFlow(size_t edge) const {
+        return built ? inner.edgeFlow(edge) : 0;
+    }
+
+private:
+    int V;
+    VertexOrder order;
+    Solver inner;
+    bool built = false;
+    vector<InputEdge> staged;
+    vector<int> new_id, old_id;
+
+    void build(int s) {
+        if (built)
+            return;
+        new_id = vertexOrder(V, staged, order, s);
+        old_id.resize(V);
+        for (int v = 0; v < V; v++)
+            old_id[new_id[v]] = v;
+        for (auto &e : staged) {
+            e.u = new_id[e.u];
+            e.v = new_id[e.v];
+        }
+        inner.addEdges(move(staged));
+        inner.finalize();
+        built = true;
+    }
+};
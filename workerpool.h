@@ -0,0 +1,208 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+
+#include "numa.h"
+
+using namespace std;
+
+// Per-worker output buffer padded to its own cache line, so workers appending to
+// neighbouring buffers don't false-share the vector headers.
+struct alignas(64) WorkerBuffer {
+    vector<int> items;
+};
+
+// ---------------- Persistent Worker Pool ----------------
+// A fixed set of threads created once and reused for every BFS level of every phase.
+// run() publishes a batch of tasks by bumping a generation counter; idle workers spin on
+// that counter for a short while and then park on a condition variable, so back-to-back
+// levels are picked up in microseconds while the pool costs nothing between phases.
+// The calling thread takes part in the batch and returns once every task is done.
+//
+// Given a NUMA topology, the participants are split into one contiguous block per node (as many
+// nodes as there are threads to go round) and each is pinned to its node's CPUs, the calling
+// thread to node 0's. runEach then lets every participant touch or scan the part of the data its
+// node owns (see NumaPartition). The calling thread stays pinned for the pool's lifetime and gets
+// its own mask back in the destructor, so the pool must be destroyed on the thread that made it.
+class WorkerPool {
+public:
+    // Total participants, including the calling thread.
+    explicit WorkerPool(int num_threads = thread::hardware_concurrency(),
+                        const NumaTopology *numa = nullptr) {
+        num_threads = max(1, num_threads);
+        num_nodes = numa ? max(1, min(numa->nodes(), num_threads)) : 1;
+        for (int i = 0; i < num_threads; i++)
+            worker_node.push_back(i * num_nodes / num_threads);
+        if (numa && num_nodes > 1) {
+            node_cpus = numa->node_cpus;
+            caller_affinity.reset(new SavedAffinity());
+            pinThread(node_cpus[0]);
+        }
+        for (int i = 1; i < num_threads; i++)
+            workers.emplace_back(&WorkerPool::workerLoop, this, i);
+    }
+
+    ~WorkerPool() {
+        {
+            lock_guard<mutex> lock(m);
+            stop.store(true);
+        }
+        wake_cv.notify_all();
+        for (auto &th : workers)
+            th.join();
+        if (caller_affinity)
+            caller_affinity->restore();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int size() const { return (int)workers.size() + 1; }
+
+    // NUMA nodes the participants are spread over (1 without a topology), and worker w's node.
+    int nodes() const { return num_nodes; }
+    int node(int worker_id) const { return worker_node[worker_id]; }
+
+    // Worker w's share of [begin, end), a range its node owns, split evenly among the node's
+    // participants.
+    pair<size_t, size_t> nodeShare(int worker_id, size_t begin, size_t end) const {
+        int n = node(worker_id);
+        int first = (int)(lower_bound(worker_node.begin(), worker_node.end(), n) - worker_node.begin());
+        int count = (int)(upper_bound(worker_node.begin(), worker_node.end(), n) - worker_node.begin()) - first;
+        int rank = worker_id - first;
+        size_t len = end - begin;
+        return {begin + len * rank / count, begin + len * (rank + 1) / count};
+    }
+
+    // Run task(i, worker_id) for every i in [0, num_tasks). worker_id is in [0, size())
+    // and identifies the executing thread, so callers can index per-worker buffers by it.
+    void run(int num_tasks, const function<void(int, int)> &task) {
+        if (workers.empty() || num_tasks <= 1) {
+            for (int i = 0; i < num_tasks; i++)
+                task(i, 0);
+            return;
+        }
+        runBatch(num_tasks, task, false);
+    }
+
+    // Run task(worker_id, worker_id) exactly once on every participant, so work can be tied to
+    // the thread (and node) that does it.
+    void runEach(const function<void(int, int)> &task) {
+        if (workers.empty()) {
+            task(0, 0);
+            return;
+        }
+        runBatch(size(), task, true);
+    }
+
+private:
+    void runBatch(int num_tasks, const function<void(int, int)> &task, bool each) {
+        job = &task;
+        job_tasks = num_tasks;
+        job_each = each;
+        next_task.store(0, memory_order_relaxed);
+        pending.store((int)workers.size(), memory_order_relaxed);
+        {
+            lock_guard<mutex> lock(m);
+            generation.fetch_add(1, memory_order_release);
+        }
+        if (sleepers.load() > 0)
+            wake_cv.notify_all();
+
+        work(0);
+
+        // Barrier: spin briefly, then park until the last worker checks in.
+        for (int spin = 0; pending.load(memory_order_acquire) != 0; spin++) {
+            if (!backoff(spin)) {
+                unique_lock<mutex> lock(m);
+                done_cv.wait(lock, [&] { return pending.load(memory_order_acquire) == 0; });
+            }
+        }
+        job = nullptr;
+    }
+
+    static const int SPIN_LIMIT = 1 << 12;   // pause-spins before yielding
+    static const int YIELD_LIMIT = 64;        // yields before parking on the condition variable
+
+    // Spin-then-park backoff shared by the workers and the caller's barrier wait.
+    // Returns false once the caller should block instead.
+    static bool backoff(int spin) {
+        if (spin < SPIN_LIMIT) {
+            cpuRelax();
+            return true;
+        }
+        if (spin < SPIN_LIMIT + YIELD_LIMIT) {
+            this_thread::yield();
+            return true;
+        }
+        return false;
+    }
+
+    vector<thread> workers;
+    mutex m;
+    condition_variable wake_cv, done_cv;
+    atomic<unsigned> generation{0};
+    atomic<int> sleepers{0};
+    atomic<int> pending{0};
+    atomic<int> next_task{0};
+    atomic<bool> stop{false};
+    const function<void(int, int)> *job = nullptr;
+    int job_tasks = 0;
+    bool job_each = false;  // runEach: one call per participant instead of claiming tasks
+    int num_nodes = 1;
+    vector<int> worker_node;
+    vector<vector<int>> node_cpus;  // empty unless the pool is pinned
+    unique_ptr<SavedAffinity> caller_affinity;  // the creating thread's mask before pinning
+
+    static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#else
+        this_thread::yield();
+#endif
+    }
+
+    // Claim tasks until the batch is exhausted.
+    void work(int worker_id) {
+        if (job_each) {
+            (*job)(worker_id, worker_id);
+            return;
+        }
+        for (int i; (i = next_task.fetch_add(1, memory_order_relaxed)) < job_tasks; )
+            (*job)(i, worker_id);
+    }
+
+    void workerLoop(int worker_id) {
+        if (!node_cpus.empty())
+            pinThread(node_cpus[node(worker_id)]);
+        unsigned seen = 0;
+        while (true) {
+            unsigned gen;
+            int spin = 0;
+            while ((gen = generation.load(memory_order_acquire)) == seen && !stop.load()) {
+                if (!backoff(spin++)) {
+                    unique_lock<mutex> lock(m);
+                    sleepers++;
+                    wake_cv.wait(lock, [&] { return generation.load() != seen || stop.load(); });
+                    sleepers--;
+                }
+            }
+            if (stop.load())
+                return;
+            seen = gen;
+
+            work(worker_id);
+
+            if (pending.fetch_sub(1, memory_order_acq_rel) == 1) {
+                lock_guard<mutex> lock(m);
+                done_cv.notify_one();
+            }
+        }
+    }
+};